@@ -4,6 +4,7 @@
 #include <set>
 #include <type_traits>
 #include <memory>
+#include <utility>
 
 #pragma region Help & Save Functions
 
@@ -418,7 +419,7 @@ bool BMTexture_GetFileName(BMPARAM_OBJECT_DECL(bmfile, objid), BMPARAM_OUT(LibCm
 	auto obj = CheckCKTexture(bmfile, objid);
 	if (obj == nullptr) return false;
 
-	BMPARAM_OUT_ASSIGN(out_filename, obj->GetUnderlyingData().GetSlotFileName(0));
+	BMPARAM_OUT_ASSIGN(out_filename, std::as_const(*obj).GetUnderlyingData().GetSlotFileName(0));
 	return true;
 }
 
@@ -427,7 +428,7 @@ bool BMTexture_LoadImage(BMPARAM_OBJECT_DECL(bmfile, objid), BMPARAM_IN(LibCmo::
 	if (obj == nullptr) return false;
 
 	// resize slot count if needed
-	if (obj->GetUnderlyingData().GetSlotCount() == 0) {
+	if (std::as_const(*obj).GetUnderlyingData().GetSlotCount() == 0) {
 		obj->GetUnderlyingData().SetSlotCount(1);
 	}
 
@@ -445,7 +446,7 @@ bool BMTexture_GetSaveOptions(BMPARAM_OBJECT_DECL(bmfile, objid), BMPARAM_OUT(Li
 	auto obj = CheckCKTexture(bmfile, objid);
 	if (obj == nullptr) return false;
 
-	BMPARAM_OUT_ASSIGN(out_saveopt, obj->GetUnderlyingData().GetSaveOptions());
+	BMPARAM_OUT_ASSIGN(out_saveopt, std::as_const(*obj).GetUnderlyingData().GetSaveOptions());
 	return true;
 }
 
@@ -865,7 +866,7 @@ bool BMMesh_GetMaterialSlot(BMPARAM_OBJECT_DECL(bmfile, objid), BMPARAM_IN(LibCm
 	if (obj == nullptr) return false;
 	if (index >= obj->GetMaterialSlotCount()) return false;
 
-	BMPARAM_OUT_ASSIGN(out_mtlid, SafeGetID(obj->GetMaterialSlots()[index]));
+	BMPARAM_OUT_ASSIGN(out_mtlid, SafeGetID(std::as_const(*obj).GetMaterialSlots()[index]));
 	return true;
 }
 bool BMMesh_SetMaterialSlot(BMPARAM_OBJECT_DECL(bmfile, objid), BMPARAM_IN(LibCmo::CKDWORD, index), BMPARAM_IN(LibCmo::CK2::CK_ID, mtlid)) {
@@ -130,8 +130,7 @@ namespace BMapInspector::Ruleset::Shared::DupCmp {
 		return combiner.finish();
 	}
 
-	size_t CKMeshHash::operator()(const O::CKMesh* _mesh) const noexcept {
-		O::CKMesh* mesh = const_cast<O::CKMesh*>(_mesh);
+	size_t CKMeshHash::operator()(const O::CKMesh* mesh) const noexcept {
 		Hasher combiner;
 
 		combiner.update(mesh->GetLitMode());
@@ -216,10 +215,7 @@ namespace BMapInspector::Ruleset::Shared::DupCmp {
 		return true;
 	}
 
-	bool CKMeshEqualTo::operator()(const O::CKMesh* _lhs, const O::CKMesh* _rhs) const {
-		O::CKMesh* lhs = const_cast<O::CKMesh*>(_lhs);
-		O::CKMesh* rhs = const_cast<O::CKMesh*>(_rhs);
-
+	bool CKMeshEqualTo::operator()(const O::CKMesh* lhs, const O::CKMesh* rhs) const {
 		// Compare lit mode
 		if (lhs->GetLitMode() != rhs->GetLitMode()) return false;
 
@@ -82,7 +82,7 @@ namespace BMapInspector::Ruleset::Shared::DupCmp {
 	};
 
 	struct CKMeshHash {
-		[[nodiscard]] size_t operator()(const BMAPINSP_O::CKMesh* _mesh) const noexcept;
+		[[nodiscard]] size_t operator()(const BMAPINSP_O::CKMesh* mesh) const noexcept;
 	};
 
 	struct CKTextureEqualTo {
@@ -94,7 +94,7 @@ namespace BMapInspector::Ruleset::Shared::DupCmp {
 	};
 
 	struct CKMeshEqualTo {
-		[[nodiscard]] bool operator()(const BMAPINSP_O::CKMesh* _lhs, const BMAPINSP_O::CKMesh* _rhs) const;
+		[[nodiscard]] bool operator()(const BMAPINSP_O::CKMesh* lhs, const BMAPINSP_O::CKMesh* rhs) const;
 	};
 
 #pragma endregion
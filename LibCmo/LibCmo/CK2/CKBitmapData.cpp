@@ -15,6 +15,14 @@ namespace LibCmo::CK2 {
 	constexpr CKDWORD SPECIFIC_FMT_NO_TRANSPARENT = 1;
 
 	bool CKBitmapData::ReadSpecificFormatBitmap(CKStateChunk* chk, VxMath::VxImageDescEx* slot) {
+		CKBitmapEncodedImage encoded;
+		if (!ReadEncodedSpecificFormatBitmap(chk, &encoded)) {
+			return false;
+		}
+		return DecodeSpecificFormatBitmap(&encoded, slot);
+	}
+
+	bool CKBitmapData::ReadEncodedSpecificFormatBitmap(CKStateChunk* chk, CKBitmapEncodedImage* encoded) {
 		// read transparent prop
 		CKDWORD transprop;
 		chk->ReadStruct(transprop);
@@ -24,44 +32,46 @@ namespace LibCmo::CK2 {
 		CKGUID fileguid;
 		chk->ReadAndFillBuffer(filerawext, CKSizeof(filerawext));
 		chk->ReadStruct(fileguid);
-		CKFileExtension fileext(filerawext);
-		auto reader = DataHandlers::CKBitmapHandler::GetBitmapHandlerWrapper(fileext, fileguid);
-		if (reader == nullptr) {
+		std::memcpy(encoded->m_RawExt, filerawext, sizeof(filerawext));
+		encoded->m_Ext = CKFileExtension(filerawext);
+		encoded->m_ReaderGuid = fileguid;
+		// check reader here, because the data can not be skipped correctly without it.
+		if (DataHandlers::CKBitmapHandler::GetBitmapHandlerWrapper(encoded->m_Ext, encoded->m_ReaderGuid) == nullptr) {
 			return false;
 		}
 
 		// read image size
 		CKDWORD imgbytesize;
 		chk->ReadStruct(imgbytesize);
+		encoded->m_Data.clear();
+		encoded->m_HasAlpha = false;
 		if (imgbytesize != 0) {
-			// get image data ptr
-			auto imgdata = chk->LockReadBufferWrapper(imgbytesize);
-			if (imgdata == nullptr) {
-				return false;
-			}
-
-			// parse image
-			VxMath::VxImageDescEx cache;
-			if (!reader->ReadMemory(imgdata.get(), imgbytesize, &cache)) {
+			// copy image data, because chunk may be freed before decoding.
+			encoded->m_Data.resize(imgbytesize);
+			if (!chk->ReadAndFillBuffer(encoded->m_Data.data(), imgbytesize)) {
 				return false;
 			}
-			// unlock buffer
-			imgdata.reset();
 
-			// post proc image (copy to slot)
-			VxMath::VxDoBlit(&cache, slot);
-
-			// proc image alpha
+			// read image alpha
 			if (transprop == SPECIFIC_FMT_HAS_TRANSPARENT) {
+				encoded->m_HasAlpha = true;
+
 				CKDWORD alphacount;
 				chk->ReadStruct(alphacount);
 				if (alphacount == 1) {
 					CKDWORD globalalpha;
 					chk->ReadStruct(globalalpha);
-					VxMath::VxDoAlphaBlit(slot, static_cast<CKBYTE>(globalalpha));
+					encoded->m_IsSameAlpha = true;
+					encoded->m_SameAlpha = static_cast<CKBYTE>(globalalpha);
 				} else {
+					encoded->m_IsSameAlpha = false;
 					auto alphabuf = chk->ReadBufferWrapper();
-					VxMath::VxDoAlphaBlit(slot, static_cast<const CKBYTE*>(alphabuf.get()));
+					const CKBYTE* alphaptr = static_cast<const CKBYTE*>(alphabuf.get());
+					if (alphaptr == nullptr) {
+						encoded->m_AlphaData.clear();
+					} else {
+						encoded->m_AlphaData.assign(alphaptr, alphaptr + alphabuf.get_deleter().GetBufferSize());
+					}
 				}
 			}
 
@@ -70,6 +80,36 @@ namespace LibCmo::CK2 {
 		return true;
 	}
 
+	bool CKBitmapData::DecodeSpecificFormatBitmap(const CKBitmapEncodedImage* encoded, VxMath::VxImageDescEx* slot) {
+		// no image data means that keep the image unchanged
+		if (encoded->m_Data.empty()) return true;
+
+		auto reader = DataHandlers::CKBitmapHandler::GetBitmapHandlerWrapper(encoded->m_Ext, encoded->m_ReaderGuid);
+		if (reader == nullptr) {
+			return false;
+		}
+
+		// parse image
+		VxMath::VxImageDescEx cache;
+		if (!reader->ReadMemory(encoded->m_Data.data(), static_cast<CKDWORD>(encoded->m_Data.size()), &cache)) {
+			return false;
+		}
+
+		// post proc image (copy to slot)
+		VxMath::VxDoBlit(&cache, slot);
+
+		// proc image alpha
+		if (encoded->m_HasAlpha) {
+			if (encoded->m_IsSameAlpha) {
+				VxMath::VxDoAlphaBlit(slot, encoded->m_SameAlpha);
+			} else if (encoded->m_AlphaData.size() >= slot->GetPixelCount()) {
+				VxMath::VxDoAlphaBlit(slot, encoded->m_AlphaData.data());
+			}
+		}
+
+		return true;
+	}
+
 	bool CKBitmapData::ReadRawBitmap(CKStateChunk* chk, VxMath::VxImageDescEx* slot) {
 		CKDWORD bytePerPixel, width, height, redMask, greenMask, blueMask, alphaMask;
 		chk->ReadStruct(bytePerPixel);	// not used
@@ -216,6 +256,35 @@ namespace LibCmo::CK2 {
 
 	}
 
+	void CKBitmapData::WriteEncodedSpecificFormatBitmap(CKStateChunk* chk, const CKBitmapEncodedImage* encoded) {
+		// write basic data in the same layout as ReadEncodedSpecificFormatBitmap() read.
+		chk->WriteStruct(encoded->m_HasAlpha ? SPECIFIC_FMT_HAS_TRANSPARENT : SPECIFIC_FMT_NO_TRANSPARENT);
+		chk->WriteBufferNoSize(encoded->m_RawExt, CKSizeof(encoded->m_RawExt));
+		chk->WriteStruct(encoded->m_ReaderGuid);
+
+		// write file data len and self
+		CKDWORD imgbytesize = static_cast<CKDWORD>(encoded->m_Data.size());
+		chk->WriteStruct(imgbytesize);
+		if (imgbytesize == 0) return;
+		chk->WriteBufferNoSize(encoded->m_Data.data(), imgbytesize);
+
+		// write alpha if it has
+		if (encoded->m_HasAlpha) {
+			// see WriteSpecificFormatBitmap() for the meaning of alpha count.
+			if (encoded->m_IsSameAlpha) {
+				chk->WriteStruct(1);
+				chk->WriteStruct(static_cast<CKDWORD>(encoded->m_SameAlpha));
+			} else {
+				chk->WriteStruct(2);
+				chk->WriteBuffer(encoded->m_AlphaData.data(), static_cast<CKDWORD>(encoded->m_AlphaData.size()));
+			}
+		}
+	}
+
+	bool CKBitmapData::IsEncodedInFormat(const CKBitmapEncodedImage* encoded, const CKBitmapProperties* savefmt) {
+		return encoded->m_Ext == savefmt->m_Ext && encoded->m_ReaderGuid == savefmt->m_ReaderGuid;
+	}
+
 	void CKBitmapData::WriteRawBitmap(CKStateChunk* chk, const VxMath::VxImageDescEx* slot) {
 		// check image validation
 		if (slot->IsValid()) {
@@ -333,10 +402,17 @@ namespace LibCmo::CK2 {
 			// and let reader to read data.
 			// and free image if is is failed.
 			if (width > 0 && height > 0) {
+				// decoding is deferred because it is slow.
+				// see DecodePendingImages() for more info.
 				for (CKDWORD i = 0; i < slotcount; ++i) {
 					CreateImage(width, height, i);
-					if (ReadSpecificFormatBitmap(chunk, GetImageDesc(i))) {
+					auto encoded = std::make_shared<CKBitmapEncodedImage>();
+					if (ReadEncodedSpecificFormatBitmap(chunk, encoded.get())) {
 						XContainer::NSXBitArray::Set(hasReadSlot, i);
+						if (!encoded->m_Data.empty()) {
+							m_Slots[i].m_EncodedImage = std::move(encoded);
+							m_Slots[i].m_IsPendingDecode = true;
+						}
 					} else {
 						ReleaseImage(i);
 					}
@@ -411,6 +487,11 @@ namespace LibCmo::CK2 {
 				} else {
 					// otherwise, set filename simply
 					SetSlotFileName(i, filename.c_str());
+					// if its image is not decoded yet,
+					// keep filename for loading it when decoding failed.
+					if (m_Slots[i].m_IsPendingDecode) {
+						m_Slots[i].m_PendingFallbackFileName = filename;
+					}
 				}
 
 			}
@@ -418,6 +499,11 @@ namespace LibCmo::CK2 {
 
 		// movie info
 		// MARK: movie is not implemented here.
+
+		// let reader decode pending images in parallel if it want.
+		if (file != nullptr && HasPendingImages()) {
+			file->AddPendingBitmap(this);
+		}
 		
 		return true;
 	}
@@ -466,7 +552,7 @@ namespace LibCmo::CK2 {
 
 			VxMath::VxImageDescEx invalidDesc;
 			for (CKDWORD i = 0; i < slotcount; ++i) {
-				VxMath::VxImageDescEx* thisimg = GetImageDesc(i);
+				const VxMath::VxImageDescEx* thisimg = GetReadOnlyImageDesc(i);
 				if (XContainer::NSXBitArray::IsSet(validExternalSavingSlot, i) || !thisimg->IsValid()) {
 					// if this slot can save as external, pass a invalid desc to writer
 					// or image is invalid, simply write it as invalid one.
@@ -492,8 +578,15 @@ namespace LibCmo::CK2 {
 			chunk->WriteStruct(32);
 
 			// write slot one by one
+			// write original encoded image back if pixels are not modified and it is in requested format.
+			// it is faster than encoding and do not lose quality for lossy format.
 			for (CKDWORD i = 0; i < slotcount; ++i) {
-				WriteSpecificFormatBitmap(chunk, GetImageDesc(i), &savefmt);
+				const CKBitmapEncodedImage* encoded = m_Slots[i].m_EncodedImage.get();
+				if (encoded != nullptr && IsEncodedInFormat(encoded, &savefmt)) {
+					WriteEncodedSpecificFormatBitmap(chunk, encoded);
+				} else {
+					WriteSpecificFormatBitmap(chunk, GetReadOnlyImageDesc(i), &savefmt);
+				}
 			}
 
 		}
@@ -514,6 +607,43 @@ namespace LibCmo::CK2 {
 		return true;
 	}
 
+	bool CKBitmapData::HasPendingImages() const {
+		for (const auto& slot : m_Slots) {
+			if (slot.m_IsPendingDecode) return true;
+		}
+		return false;
+	}
+
+	void CKBitmapData::DecodePendingImages() {
+		for (CKDWORD i = 0; i < GetSlotCount(); ++i) {
+			InternalDecodePendingImage(i);
+		}
+	}
+
+	void CKBitmapData::InternalDecodePendingImage(CKDWORD slot) {
+		CKBitmapSlot& slotdata = m_Slots[slot];
+		if (!slotdata.m_IsPendingDecode) return;
+
+		// clear pending flag first, so the following operations will not decode it again.
+		// encoded image is kept for writing it back.
+		XContainer::XString fallback(std::move(slotdata.m_PendingFallbackFileName));
+		slotdata.m_IsPendingDecode = false;
+		slotdata.m_PendingFallbackFileName.clear();
+
+		if (DecodeSpecificFormatBitmap(slotdata.m_EncodedImage.get(), &slotdata.m_ImageData)) return;
+
+		// decoding failed. treat it as not loaded image,
+		// try resolving its file name and load it.
+		// the broken encoded image is dropped in ReleaseImage().
+		ReleaseImage(slot);
+		slotdata.m_FileName.clear();
+		if (!fallback.empty() && m_Context->GetPathManager()->ResolveFileName(fallback)) {
+			if (LoadImage(fallback.c_str(), slot)) {
+				SetSlotFileName(slot, fallback.c_str());
+			}
+		}
+	}
+
 #pragma endregion
 
 #pragma region Slot Functions
@@ -549,6 +679,7 @@ namespace LibCmo::CK2 {
 		if (Slot >= m_Slots.size()) return false;
 
 		CKBitmapSlot& slotdata = m_Slots[Slot];
+		slotdata.DropEncodedImage();
 		slotdata.m_ImageData.CreateImage(Width, Height);
 		VxMath::VxDoAlphaBlit(&slotdata.m_ImageData, 0xFFu);
 		return true;
@@ -568,9 +699,12 @@ namespace LibCmo::CK2 {
 		if (reader == nullptr) return false;
 
 		// get desc and read data
-		if (!reader->ReadFile(filename, GetImageDesc(slot))) {
+		// use slot image directly because pending image will be overwritten.
+		CKBitmapSlot& slotdata = m_Slots[slot];
+		if (!reader->ReadFile(filename, &slotdata.m_ImageData)) {
 			return false;
 		}
+		slotdata.DropEncodedImage();
 
 		return true;
 	}
@@ -599,7 +733,7 @@ namespace LibCmo::CK2 {
 		if (reader == nullptr) return false;
 
 		// save file
-		if (!reader->SaveFile(filename, GetImageDesc(slot), savefmt)) {
+		if (!reader->SaveFile(filename, GetReadOnlyImageDesc(slot), savefmt)) {
 			return false;
 		}
 
@@ -608,11 +742,22 @@ namespace LibCmo::CK2 {
 
 	VxMath::VxImageDescEx* CKBitmapData::GetImageDesc(CKDWORD slot) {
 		if (slot >= m_Slots.size()) return nullptr;
+		// decode image first because caller may access its pixels.
+		// and caller may modify its pixels, so encoded image is out of date.
+		InternalDecodePendingImage(slot);
+		m_Slots[slot].DropEncodedImage();
+		return &m_Slots[slot].m_ImageData;
+	}
+
+	const VxMath::VxImageDescEx* CKBitmapData::GetReadOnlyImageDesc(CKDWORD slot) {
+		if (slot >= m_Slots.size()) return nullptr;
+		InternalDecodePendingImage(slot);
 		return &m_Slots[slot].m_ImageData;
 	}
 
 	void CKBitmapData::ReleaseImage(CKDWORD slot) {
 		if (slot >= m_Slots.size()) return;
+		m_Slots[slot].DropEncodedImage();
 		m_Slots[slot].m_ImageData.FreeImage();
 	}
 
@@ -677,6 +822,15 @@ namespace LibCmo::CK2 {
 
 	void CKBitmapData::SetSaveFormat(const CKBitmapProperties& props) {
 		m_SaveProperties = props;
+
+		// forget encoded images which can not be written back in new format.
+		// the image pending decode is kept because it is the only source of its pixels.
+		for (auto& slot : m_Slots) {
+			if (slot.m_EncodedImage == nullptr || slot.m_IsPendingDecode) continue;
+			if (!IsEncodedInFormat(slot.m_EncodedImage.get(), &m_SaveProperties)) {
+				slot.DropEncodedImage();
+			}
+		}
 	}
 
 	CK_TEXTURE_SAVEOPTIONS CKBitmapData::GetSaveOptions() const {
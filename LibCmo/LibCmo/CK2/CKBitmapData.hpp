@@ -2,6 +2,7 @@
 
 #include "../VTInternal.hpp"
 #include <yycc/macro/class_copy_move.hpp>
+#include <memory>
 
 namespace LibCmo::CK2 {
 
@@ -22,15 +23,61 @@ namespace LibCmo::CK2 {
 		CKDWORD m_MovieFileName;	/**< CK_STATESAVEFLAGS_TEXTURE::CK_STATESAVE_TEXAVIFILENAME(0x1000) in default. */
 	};
 
+	/**
+	 * @brief The image stored in specific format (e.g. PNG, JPG) which is read from CKStateChunk.
+	 * @details It holds all data of this image in chunk, so it can be decoded later, or written back as it is.
+	*/
+	struct CKBitmapEncodedImage {
+		CKBitmapEncodedImage() :
+			m_RawExt(), m_Ext(), m_ReaderGuid(), m_Data(),
+			m_HasAlpha(false), m_IsSameAlpha(false), m_SameAlpha(0), m_AlphaData() {}
+
+		CKCHAR m_RawExt[4]; /**< The extension bytes stored in chunk. It is written back without any change. */
+		CKFileExtension m_Ext;
+		CKGUID m_ReaderGuid;
+		XContainer::XArray<CKBYTE> m_Data; /**< The encoded image file data. Empty if there is no image data. */
+		bool m_HasAlpha; /**< True if alpha channel is stored separately and should be applied after decoding. */
+		bool m_IsSameAlpha; /**< True if all pixels use m_SameAlpha as their alpha. Otherwise m_AlphaData is used. */
+		CKBYTE m_SameAlpha;
+		XContainer::XArray<CKBYTE> m_AlphaData;
+	};
+
 	class CKBitmapSlot {
 	public:
 		CKBitmapSlot() :
-			m_ImageData(), m_FileName() {}
+			m_ImageData(), m_FileName(),
+			m_EncodedImage(nullptr), m_IsPendingDecode(false), m_PendingFallbackFileName() {}
 		~CKBitmapSlot() {}
 		YYCC_DEFAULT_COPY_MOVE(CKBitmapSlot)
 
+		/**
+		 * @brief Forget the encoded image because the pixels of m_ImageData are (or may be) changed.
+		*/
+		void DropEncodedImage() {
+			m_EncodedImage = nullptr;
+			m_IsPendingDecode = false;
+			m_PendingFallbackFileName.clear();
+		}
+
 		VxMath::VxImageDescEx m_ImageData;
 		XContainer::XString m_FileName;
+		/**
+		 * @brief The original encoded image of m_ImageData.
+		 * @details
+		 * It is kept until the pixels of m_ImageData may be modified,
+		 * so that it can be written back without decoding and encoding again.
+		 * nullptr if there is no encoded image or pixels are modified.
+		*/
+		std::shared_ptr<const CKBitmapEncodedImage> m_EncodedImage;
+		/**
+		 * @brief True if m_EncodedImage should be decoded into m_ImageData before accessing its pixels.
+		*/
+		bool m_IsPendingDecode;
+		/**
+		 * @brief The file name loaded into m_ImageData when decoding m_EncodedImage failed.
+		 * @details It is resolved by CKPathManager before loading. Empty if there is no fallback.
+		*/
+		XContainer::XString m_PendingFallbackFileName;
 	};
 
 	class CKBitmapData {
@@ -42,14 +89,63 @@ namespace LibCmo::CK2 {
 #pragma region RW Funcs
 
 		static bool ReadSpecificFormatBitmap(CKStateChunk* chk, VxMath::VxImageDescEx* slot);
+		/**
+		 * @brief Read specific format image from CKStateChunk without decoding it.
+		 * @param[in] chk The chunk to read.
+		 * @param[out] encoded The struct receiving the encoded image.
+		 * @return True if success. The chunk is read in the same way as ReadSpecificFormatBitmap().
+		*/
+		static bool ReadEncodedSpecificFormatBitmap(CKStateChunk* chk, CKBitmapEncodedImage* encoded);
+		/**
+		 * @brief Decode the image read by ReadEncodedSpecificFormatBitmap() into given image.
+		 * @param[in] encoded The encoded image.
+		 * @param[in] slot The image receiving decoded data. Its size should be set before calling this.
+		 * @return True if success.
+		 * @remarks This function do not touch any shared data, so it can be called in worker threads.
+		*/
+		static bool DecodeSpecificFormatBitmap(const CKBitmapEncodedImage* encoded, VxMath::VxImageDescEx* slot);
 		static bool ReadRawBitmap(CKStateChunk* chk, VxMath::VxImageDescEx* slot);
 		static bool ReadOldRawBitmap(CKStateChunk* chk, VxMath::VxImageDescEx* slot);
 		static void WriteSpecificFormatBitmap(CKStateChunk* chk, const VxMath::VxImageDescEx* slot, const CKBitmapProperties* savefmt);
+		/**
+		 * @brief Write the image read by ReadEncodedSpecificFormatBitmap() back without any change.
+		 * @param[in] chk The chunk to write.
+		 * @param[in] encoded The encoded image.
+		*/
+		static void WriteEncodedSpecificFormatBitmap(CKStateChunk* chk, const CKBitmapEncodedImage* encoded);
+		/**
+		 * @brief Check whether the encoded image is stored in given format.
+		 * @param[in] encoded The encoded image.
+		 * @param[in] savefmt The format to be checked.
+		 * @return True if it is, so that it can be written back instead of encoding it in given format again.
+		*/
+		static bool IsEncodedInFormat(const CKBitmapEncodedImage* encoded, const CKBitmapProperties* savefmt);
 		static void WriteRawBitmap(CKStateChunk* chk, const VxMath::VxImageDescEx* slot);
 
 		bool ReadFromChunk(CKStateChunk* chunk, CKFileVisitor* file, const CKBitmapDataReadIdentifiers& identifiers);
 		bool DumpToChunk(CKStateChunk* chunk, CKFileVisitor* file, const CKBitmapDataWriteIdentifiers& identifiers);
 
+		/**
+		 * @brief Check whether there are images whose decoding is deferred.
+		 * @return True if there are.
+		*/
+		bool HasPendingImages() const;
+		/**
+		 * @brief Decode all images whose decoding is deferred by ReadFromChunk().
+		 * @remarks
+		 * \li ReadFromChunk() only read the encoded data of specific format images.
+		 * They are decoded when their pixels are accessed at the first time (e.g. GetImageDesc()),
+		 * or by CKFileReader in worker threads before DeepLoad() returns if it is requested.
+		 * See CKFileReader::SetDecodeImages().
+		 * \li If decoding failed, the image file indicated by slot file name will be loaded instead,
+		 * like what ReadFromChunk() does for the slot without embedded image.
+		 * \li The encoded data is kept after decoding, and written back by DumpToChunk()
+		 * if the pixels are not modified. See GetImageDesc() and GetReadOnlyImageDesc().
+		 * \li This function only touch the slots of this object,
+		 * so it is safe to call it for different objects in different threads.
+		*/
+		void DecodePendingImages();
+
 #pragma endregion
 
 #pragma region Slot funcs
@@ -83,11 +179,22 @@ namespace LibCmo::CK2 {
 		*/
 		bool SaveImage(CKSTRING filename, CKDWORD slot, bool isForceThisFmt = false);
 		/**
-		 * @brief Get specified slot image descriptor.
+		 * @brief Get specified slot image descriptor for modification.
 		 * @param[in] slot The slot to get.
 		 * @return The descriptor. nullptr if failed.
+		 * @remarks
+		 * The image is assumed to be modified after calling this,
+		 * so the original encoded image will not be written back when saving.
+		 * Use GetReadOnlyImageDesc() if you only read pixels.
 		*/
 		VxMath::VxImageDescEx* GetImageDesc(CKDWORD slot);
+		/**
+		 * @brief Get specified slot image descriptor for reading.
+		 * @param[in] slot The slot to get.
+		 * @return The descriptor. nullptr if failed.
+		 * @remarks Unlike GetImageDesc(), the original encoded image is kept and will be written back when saving.
+		*/
+		const VxMath::VxImageDescEx* GetReadOnlyImageDesc(CKDWORD slot);
 		/**
 		 * @brief Release specified slot image.
 		 * @param[in] slot The slot to free.
@@ -128,6 +235,13 @@ namespace LibCmo::CK2 {
 		bool IsCubeMap() const;
 		
 		const CKBitmapProperties& GetSaveFormat() const;
+		/**
+		 * @brief Set the format used when saving images in specific format.
+		 * @param[in] props The new format.
+		 * @remarks
+		 * The decoded images whose original encoded image is not in new format will forget it,
+		 * because it will not be written back anymore. See DumpToChunk().
+		*/
 		void SetSaveFormat(const CKBitmapProperties& props);
 		CK_TEXTURE_SAVEOPTIONS GetSaveOptions() const;
 		void SetSaveOptions(CK_TEXTURE_SAVEOPTIONS opts);
@@ -190,6 +304,12 @@ namespace LibCmo::CK2 {
 #pragma endregion
 
 	protected:
+		/**
+		 * @brief Decode the deferred image of specified slot if it has.
+		 * @param[in] slot The slot to decode. It must be valid.
+		*/
+		void InternalDecodePendingImage(CKDWORD slot);
+
 		CKContext* m_Context;
 		XContainer::XArray<CKBitmapSlot> m_Slots;
 		CKDWORD m_CurrentSlot;
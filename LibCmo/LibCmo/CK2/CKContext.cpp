@@ -1,10 +1,13 @@
 #include "CKContext.hpp"
 #include "ObjImpls/CKObject.hpp"
+#include "ObjImpls/CKTexture.hpp"
 #include "MgrImpls/CKBaseManager.hpp"
 #include "MgrImpls/CKObjectManager.hpp"
 #include "MgrImpls/CKPathManager.hpp"
 #include <yycc/string/op.hpp>
 #include <cstdarg>
+#include <cstring>
+#include <utility>
 
 namespace LibCmo::CK2 {
 
@@ -22,9 +25,13 @@ namespace LibCmo::CK2 {
 		m_GlobalImagesSaveOptions(CK_TEXTURE_SAVEOPTIONS::CKTEXTURE_RAWDATA),
 		m_GlobalSoundsSaveOptions(CK_SOUND_SAVEOPTIONS::CKSOUND_EXTERNAL),
 		m_GlobalImagesSaveFormat(),
+		m_WorkerThreadCount(1u),
+		m_FileCrcVerifyMode(CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY),
 		// misc init
-		m_NameEncoding(),
-		m_OutputCallback(nullptr) {
+		m_NameEncoding(), m_NameEncodingMutex(),
+		m_UTF8Memo(), m_OrdinaryMemo(),
+		m_NamePool(), m_NamePoolMutex(),
+		m_OutputCallback(nullptr), m_OutputMutex() {
 
 		// setup save format
 		m_GlobalImagesSaveFormat.m_Ext.SetExt(u8"bmp");
@@ -225,8 +232,9 @@ namespace LibCmo::CK2 {
 	}
 
 	void CKContext::SetGlobalImagesSaveOptions(CK_TEXTURE_SAVEOPTIONS Options) {
-		if (Options != CK_TEXTURE_SAVEOPTIONS::CKTEXTURE_USEGLOBAL) {
+		if (Options != CK_TEXTURE_SAVEOPTIONS::CKTEXTURE_USEGLOBAL && Options != m_GlobalImagesSaveOptions) {
 			m_GlobalImagesSaveOptions = Options;
+			MarkGlobalImagesSaveUsersDirty();
 		}
 	}
 
@@ -235,7 +243,20 @@ namespace LibCmo::CK2 {
 	}
 
 	void CKContext::SetGlobalImagesSaveFormat(const CKBitmapProperties& Format) {
+		if (Format.m_Ext == m_GlobalImagesSaveFormat.m_Ext && Format.m_ReaderGuid == m_GlobalImagesSaveFormat.m_ReaderGuid) return;
 		m_GlobalImagesSaveFormat = Format;
+		MarkGlobalImagesSaveUsersDirty();
+	}
+
+	void CKContext::MarkGlobalImagesSaveUsersDirty() {
+		// the saved data of textures using global options is changed,
+		// so their loaded CKStateChunk can not be reused.
+		for (auto* obj : m_ObjectManager->GetObjectByNameAndClass(nullptr, CK_CLASSID::CKCID_TEXTURE, true)) {
+			auto* tex = static_cast<ObjImpls::CKTexture*>(obj);
+			if (std::as_const(*tex).GetUnderlyingData().GetSaveOptions() == CK_TEXTURE_SAVEOPTIONS::CKTEXTURE_USEGLOBAL) {
+				tex->SetDirty(true);
+			}
+		}
 	}
 
 	CK_SOUND_SAVEOPTIONS CKContext::GetGlobalSoundsSaveOptions() {
@@ -248,12 +269,28 @@ namespace LibCmo::CK2 {
 		}
 	}
 
+	void CKContext::SetWorkerThreadCount(CKDWORD count) {
+		m_WorkerThreadCount = count;
+	}
+
+	CKDWORD CKContext::GetWorkerThreadCount() {
+		return m_WorkerThreadCount;
+	}
+
+	void CKContext::SetFileCrcVerifyMode(CK_FILE_CRCVERIFYMODE mode) {
+		m_FileCrcVerifyMode = mode;
+	}
+
+	CK_FILE_CRCVERIFYMODE CKContext::GetFileCrcVerifyMode() {
+		return m_FileCrcVerifyMode;
+	}
 
 #pragma endregion
 
 #pragma region Output utilities
 
 	void CKContext::OutputToConsole(CKSTRING str) {
+		std::lock_guard<std::mutex> locker(m_OutputMutex);
 		if (m_OutputCallback == nullptr) return;
 		if (str == nullptr) return;
 		m_OutputCallback(str);
@@ -270,10 +307,11 @@ namespace LibCmo::CK2 {
 
 		// use c_str(), not XContainer::NSXString::ToCKSTRING because we want make sure this parameter is not nullptr.
 		// we always output a valid C style string, even if no chars need to write.
-		m_OutputCallback(result.c_str());
+		this->OutputToConsole(result.c_str());
 	}
 
 	void CKContext::SetOutputCallback(OutputCallback cb) {
+		std::lock_guard<std::mutex> locker(m_OutputMutex);
 		m_OutputCallback = cb;
 	}
 
@@ -281,34 +319,140 @@ namespace LibCmo::CK2 {
 
 #pragma region Encoding utilities
 
-	bool CKContext::GetUTF8String(const std::string& native_name, XContainer::XString& u8_name) {
-		bool conv_success = false, has_valid_token = false;
+	/**
+	 * @brief Check whether given string only contains ASCII characters.
+	 * @details Check 8 bytes at once and then check remaining bytes one by one.
+	 * @param[in] str The string to be checked.
+	 * @param[in] len The length of string.
+	 * @return True if it is.
+	*/
+	static bool IsAsciiString(const void* str, size_t len) {
+		constexpr CKQWORD c_HighBits = CKQWORD_C(0x8080808080808080);
+		const CKBYTE* p = static_cast<const CKBYTE*>(str);
+
+		CKQWORD merged = 0u;
+		for (; len >= sizeof(CKQWORD); len -= sizeof(CKQWORD), p += sizeof(CKQWORD)) {
+			CKQWORD word;
+			std::memcpy(&word, p, sizeof(CKQWORD));
+			merged |= word;
+		}
+		if (merged & c_HighBits) return false;
+
+		for (; len > 0u; --len, ++p) {
+			if (*p & 0x80u) return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Get the first valid encoding in encoding sequence.
+	 * @return The first valid encoding, or nullptr if there is no valid encoding.
+	*/
+	static EncodingPair* GetFirstValidEncoding(XContainer::XArray<EncodingPair>& encodings) {
+		for (auto& enc_pair : encodings) {
+			if (enc_pair.IsValid()) return &enc_pair;
+		}
+		return nullptr;
+	}
+
+	bool CKContext::InternalGetUTF8String(const std::string& native_name, XContainer::XString& u8_name, bool& has_valid_token) {
+		// fast path: pure ASCII string is kept unchanged by ASCII compatible encoding.
+		// only the first valid encoding matters, because it is always tried first.
+		EncodingPair* first_enc = GetFirstValidEncoding(this->m_NameEncoding);
+		has_valid_token = first_enc != nullptr;
+		if (first_enc != nullptr && first_enc->IsAsciiCompatible() && IsAsciiString(native_name.data(), native_name.size())) {
+			u8_name.assign(native_name.begin(), native_name.end());
+			return true;
+		}
+
+		// check memo
+		const XContainer::XString* memo = this->m_UTF8Memo.Get(native_name);
+		if (memo != nullptr) {
+			u8_name = *memo;
+			return true;
+		}
+
+		// do real convertion
 		for (auto& enc_pair : this->m_NameEncoding) {
 			if (!enc_pair.IsValid()) continue;
-			has_valid_token = true;
-			conv_success = enc_pair.ToUTF8(native_name, u8_name);
-			if (conv_success) break;
+			if (enc_pair.ToUTF8(native_name, u8_name)) {
+				this->m_UTF8Memo.Put(native_name, u8_name);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void CKContext::InternalUTF8StringFallback(bool has_valid_token, XContainer::XString& u8_name) {
+		if (!has_valid_token) {
+			throw RuntimeException("Try to get UTF8 string from ordinary string in CKContext but giving empty encoding candidate.");
+		} else {
+			u8_name.clear();
+			this->OutputToConsole(u8"Error when converting to UTF8 string from ordinary string. The string will leave to blank.");
+		}
+	}
+
+	bool CKContext::GetUTF8String(const std::string& native_name, XContainer::XString& u8_name) {
+		bool conv_success = false, has_valid_token = false;
+		{
+			std::lock_guard<std::mutex> locker(this->m_NameEncodingMutex);
+			conv_success = this->InternalGetUTF8String(native_name, u8_name, has_valid_token);
 		}
 		// fallback if failed.
 		if (!conv_success) {
-			if (!has_valid_token) {
-				throw RuntimeException("Try to get UTF8 string from ordinary string in CKContext but giving empty encoding candidate.");
-			} else {
-				u8_name.clear();
-				this->OutputToConsole(u8"Error when converting to UTF8 string from ordinary string. The string will leave to blank.");
-			}
+			this->InternalUTF8StringFallback(has_valid_token, u8_name);
 		}
 		// return value
 		return conv_success;
 	}
 
+	bool CKContext::GetUTF8Strings(const XContainer::XArray<std::string>& native_names, XContainer::XArray<XContainer::XString>& u8_names) {
+		u8_names.resize(native_names.size());
+
+		// convert all of them with one lock and record failed ones
+		bool all_success = true, has_valid_token = false;
+		XContainer::XArray<size_t> failed;
+		{
+			std::lock_guard<std::mutex> locker(this->m_NameEncodingMutex);
+			for (size_t i = 0; i < native_names.size(); ++i) {
+				if (!this->InternalGetUTF8String(native_names[i], u8_names[i], has_valid_token)) {
+					failed.emplace_back(i);
+				}
+			}
+		}
+		// fallback for failed ones
+		for (const auto& i : failed) {
+			all_success = false;
+			this->InternalUTF8StringFallback(has_valid_token, u8_names[i]);
+		}
+		return all_success;
+	}
+
 	bool CKContext::GetOrdinaryString(const XContainer::XString& u8_name, std::string& native_name) {
 		bool conv_success = false, has_valid_token = false;
-		for (auto& enc_pair : this->m_NameEncoding) {
-			if (!enc_pair.IsValid()) continue;
-			has_valid_token = true;
-			conv_success = enc_pair.ToOrdinary(u8_name, native_name);
-			if (conv_success) break;
+		{
+			std::lock_guard<std::mutex> locker(this->m_NameEncodingMutex);
+			EncodingPair* first_enc = GetFirstValidEncoding(this->m_NameEncoding);
+			has_valid_token = first_enc != nullptr;
+			const std::string* memo = nullptr;
+			if (first_enc != nullptr && first_enc->IsAsciiCompatible() && IsAsciiString(u8_name.data(), u8_name.size())) {
+				// fast path for pure ASCII string
+				native_name.assign(u8_name.begin(), u8_name.end());
+				conv_success = true;
+			} else if ((memo = this->m_OrdinaryMemo.Get(u8_name)) != nullptr) {
+				// memorized result
+				native_name = *memo;
+				conv_success = true;
+			} else {
+				for (auto& enc_pair : this->m_NameEncoding) {
+					if (!enc_pair.IsValid()) continue;
+					conv_success = enc_pair.ToOrdinary(u8_name, native_name);
+					if (conv_success) {
+						this->m_OrdinaryMemo.Put(u8_name, native_name);
+						break;
+					}
+				}
+			}
 		}
 		// fallback if failed.
 		if (!conv_success) {
@@ -327,13 +471,26 @@ namespace LibCmo::CK2 {
 		// free all current series
 		this->ClearEncoding();
 		// add new encoding
+		std::lock_guard<std::mutex> locker(this->m_NameEncodingMutex);
 		for (auto& encoding_str : encoding_seq) {
 			this->m_NameEncoding.emplace_back(EncodingPair(encoding_str));
 		}
 	}
 
 	void CKContext::ClearEncoding() {
-		this->m_NameEncoding.clear();
+		{
+			std::lock_guard<std::mutex> locker(this->m_NameEncodingMutex);
+			this->m_NameEncoding.clear();
+			this->m_UTF8Memo.Clear();
+			this->m_OrdinaryMemo.Clear();
+		}
+
+		// cached ordinary names are invalid now
+		std::lock_guard<std::mutex> locker(this->m_NamePoolMutex);
+		for (auto& [key, entry] : this->m_NamePool) {
+			entry->m_HasOrdinaryName = false;
+			entry->m_OrdinaryName.clear();
+		}
 	}
 
 	bool CKContext::IsValidEncoding() {
@@ -345,4 +502,70 @@ namespace LibCmo::CK2 {
 
 #pragma endregion
 
+#pragma region Name Pool
+
+	CKSTRING CKContext::InternName(CKSTRING name) {
+		if (name == nullptr || name[0] == u8'\0') return nullptr;
+
+		std::lock_guard<std::mutex> locker(this->m_NamePoolMutex);
+		auto finder = this->m_NamePool.find(std::u8string_view(name));
+		if (finder != this->m_NamePool.end()) {
+			++finder->second->m_RefCount;
+			return finder->second->m_Name.c_str();
+		}
+
+		// not interned. create new entry.
+		// the key is a view of the name owned by entry, so it is stable.
+		auto entry = std::make_unique<InternedName>();
+		entry->m_Name = name;
+		entry->m_RefCount = 1u;
+		entry->m_HasOrdinaryName = false;
+		entry->m_IsOrdinaryNameValid = false;
+		CKSTRING interned = entry->m_Name.c_str();
+		this->m_NamePool.emplace(std::u8string_view(entry->m_Name), std::move(entry));
+		return interned;
+	}
+
+	void CKContext::ReleaseName(CKSTRING interned_name) {
+		if (interned_name == nullptr) return;
+
+		std::lock_guard<std::mutex> locker(this->m_NamePoolMutex);
+		auto finder = this->m_NamePool.find(std::u8string_view(interned_name));
+		if (finder == this->m_NamePool.end()) throw LogicException("Given name is not interned.");
+
+		// remove entry if nobody use it
+		if (--finder->second->m_RefCount == 0u) {
+			this->m_NamePool.erase(finder);
+		}
+	}
+
+	CKSTRING CKContext::FindInternedName(CKSTRING name) {
+		if (name == nullptr || name[0] == u8'\0') return nullptr;
+
+		std::lock_guard<std::mutex> locker(this->m_NamePoolMutex);
+		auto finder = this->m_NamePool.find(std::u8string_view(name));
+		if (finder == this->m_NamePool.end()) return nullptr;
+		return finder->second->m_Name.c_str();
+	}
+
+	bool CKContext::GetOrdinaryName(CKSTRING interned_name, std::string& native_name) {
+		if (interned_name == nullptr) throw LogicException("nullptr is not allowed in GetOrdinaryName().");
+
+		std::lock_guard<std::mutex> locker(this->m_NamePoolMutex);
+		auto finder = this->m_NamePool.find(std::u8string_view(interned_name));
+		if (finder == this->m_NamePool.end()) throw LogicException("Given name is not interned.");
+
+		// convert it if it is not cached.
+		auto& entry = *finder->second;
+		if (!entry.m_HasOrdinaryName) {
+			entry.m_IsOrdinaryNameValid = this->GetOrdinaryString(entry.m_Name, entry.m_OrdinaryName);
+			entry.m_HasOrdinaryName = true;
+		}
+
+		native_name = entry.m_OrdinaryName;
+		return entry.m_IsOrdinaryNameValid;
+	}
+
+#pragma endregion
+
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include <map>
 #include <deque>
 #include <functional>
+#include <mutex>
+#include <memory>
+#include <string_view>
 
 namespace LibCmo::CK2 {
 
@@ -28,6 +31,8 @@ namespace LibCmo::CK2 {
 	public:
 		/**
 		 * @brief Simply clear all CKContext to restore its status.
+		 * @remarks The CK_ID held before calling this will not resolve to any object created after it,
+		 * because the generation of CK_ID is kept. See CKObjectManager::DestroyAllObjects().
 		*/
 		void ClearAll();
 
@@ -91,13 +96,46 @@ namespace LibCmo::CK2 {
 
 		CK_SOUND_SAVEOPTIONS GetGlobalSoundsSaveOptions();
 		void SetGlobalSoundsSaveOptions(CK_SOUND_SAVEOPTIONS Options);
+
+		/**
+		 * @brief Set the count of worker threads used when loading or saving file.
+		 * @param[in] count The count of workers. 1 means process all data in caller thread sequentially.
+		 * 0 means use all available hardware threads.
+		 * @remarks
+		 * \li Only the parts which are independent with each other will be dispatched into workers.
+		 * For example, converting CKStateChunk from file buffer when loading,
+		 * and serializing objects into CKStateChunk when saving.
+		 * \li Object creation, object loading and manager serialization are always executed in caller thread.
+		*/
+		void SetWorkerThreadCount(CKDWORD count);
+		CKDWORD GetWorkerThreadCount();
+
+		/**
+		 * @brief Set how the CRC of file is verified when loading file.
+		 * @param[in] mode The verify mode. Default is CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY.
+		 * @remarks
+		 * When verifying in background, the mismatched CRC is reported through output callback,
+		 * and the loading will not be stopped.
+		 * The background verification is finished before the destruction of CKFileReader at the latest.
+		*/
+		void SetFileCrcVerifyMode(CK_FILE_CRCVERIFYMODE mode);
+		CK_FILE_CRCVERIFYMODE GetFileCrcVerifyMode();
 		
 	protected:
+		/**
+		 * @brief Mark the textures using global images save options as modified.
+		 * @details Called when global images save options or format is changed,
+		 * because their CKStateChunk loaded from file is not identical to what will be saved anymore.
+		*/
+		void MarkGlobalImagesSaveUsersDirty();
+
 		CKINT m_CompressionLevel;
 		CK_FILE_WRITEMODE m_FileWriteMode;
 		CK_TEXTURE_SAVEOPTIONS m_GlobalImagesSaveOptions;
 		CK_SOUND_SAVEOPTIONS m_GlobalSoundsSaveOptions;
 		CKBitmapProperties m_GlobalImagesSaveFormat;
+		CKDWORD m_WorkerThreadCount;
+		CK_FILE_CRCVERIFYMODE m_FileCrcVerifyMode;
 
 		// ========== Encoding utilities ==========
 	public:
@@ -127,6 +165,18 @@ namespace LibCmo::CK2 {
 		 * So becore using this function, please make sure that you have checked by calling IsValidEncoding().
 		*/
 		bool GetOrdinaryString(const XContainer::XString& u8_name, std::string& native_name);
+		/**
+		 * @brief Convert a batch of ordinary strings to UTF8 strings.
+		 * @param[in] native_names The input ordinary strings.
+		 * @param[out] u8_names The output UTF8 strings. It has the same size with input.
+		 * @return True if all convertions are success, otherwise false.
+		 * @exception RuntimeException Raised when perform this operation with a blank encoding sequence.
+		 * @remarks
+		 * Same as calling GetUTF8String() for each string,
+		 * but the encoding sequence is only locked once.
+		 * It is used by CKFileReader to convert all object names in file header.
+		*/
+		bool GetUTF8Strings(const XContainer::XArray<std::string>& native_names, XContainer::XArray<XContainer::XString>& u8_names);
 		/**
 		 * @brief Set the encoding sequence.
 		 * @param[in] encoding_series The encoding name in this sequence.
@@ -147,7 +197,119 @@ namespace LibCmo::CK2 {
 		bool IsValidEncoding();
 		
 	protected:
+		/**
+		 * @brief The LRU memo of encoding convertion results.
+		 * @details Only non-ASCII strings are put in it, because ASCII strings are converted by direct copy.
+		*/
+		template<typename TKey, typename TValue>
+		class EncodingMemo {
+		public:
+			EncodingMemo() : m_Items(), m_Index() {}
+			/**
+			 * @brief Get memorized value and mark it as recently used.
+			 * @return The pointer to memorized value, or nullptr if not found.
+			*/
+			const TValue* Get(const TKey& key) {
+				auto finder = m_Index.find(key);
+				if (finder == m_Index.end()) return nullptr;
+				m_Items.splice(m_Items.begin(), m_Items, finder->second);
+				return &finder->second->second;
+			}
+			/**
+			 * @brief Memorize value and drop the least recently used one if memo is full.
+			*/
+			void Put(const TKey& key, const TValue& value) {
+				if (m_Index.contains(key)) return;
+				m_Items.emplace_front(key, value);
+				m_Index.emplace(key, m_Items.begin());
+				if (m_Items.size() > c_EncodingMemoSize) {
+					m_Index.erase(m_Items.back().first);
+					m_Items.pop_back();
+				}
+			}
+			void Clear() {
+				m_Index.clear();
+				m_Items.clear();
+			}
+		private:
+			XContainer::XList<std::pair<TKey, TValue>> m_Items; /**< The memorized items. The front is the most recently used one. */
+			XContainer::XHashTable<TKey, typename XContainer::XList<std::pair<TKey, TValue>>::iterator> m_Index;
+		};
+		static constexpr size_t c_EncodingMemoSize = 4096u;
+
+		/**
+		 * @brief The real worker of GetUTF8String() without locking and fallback.
+		*/
+		bool InternalGetUTF8String(const std::string& native_name, XContainer::XString& u8_name, bool& has_valid_token);
+		/**
+		 * @brief Output error or raise exception for failed convertion, like GetUTF8String() does.
+		*/
+		void InternalUTF8StringFallback(bool has_valid_token, XContainer::XString& u8_name);
+
 		XContainer::XArray<EncodingPair> m_NameEncoding;
+		/**
+		 * @brief The mutex protecting m_NameEncoding and encoding memos.
+		 * @details Encoding convertion is stateful and it may be called from worker threads when saving file.
+		*/
+		std::mutex m_NameEncodingMutex;
+		EncodingMemo<std::string, XContainer::XString> m_UTF8Memo;
+		EncodingMemo<XContainer::XString, std::string> m_OrdinaryMemo;
+
+		// ========== Name Pool ==========
+	public:
+		/**
+		 * @brief Get the interned version of given name.
+		 * @param[in] name The name to be interned. nullptr is allowed.
+		 * @return The interned name which is owned by this context.
+		 * Equal names always get the same pointer, so interned names can be compared by pointer.
+		 * nullptr if given name is nullptr or blank.
+		 * @remarks
+		 * \li Each call adds a reference to the interned name.
+		 * The returned pointer is valid until it is released by ReleaseName() as many times as it is interned.
+		 * So the names which are not used anymore (e.g. old names of renamed objects) are freed.
+		 * \li The object name and the name of CKFileObject are stored in this pool.
+		*/
+		CKSTRING InternName(CKSTRING name);
+		/**
+		 * @brief Release one reference to the interned name.
+		 * @param[in] interned_name The name returned by InternName(). nullptr is allowed and will be ignored.
+		 * @remarks The name is removed from pool when all of its references are released.
+		*/
+		void ReleaseName(CKSTRING interned_name);
+		/**
+		 * @brief Find the interned version of given name without adding it into pool.
+		 * @param[in] name The name to be found. nullptr is allowed.
+		 * @return The interned name, or nullptr if it is not interned, nullptr or blank.
+		 * @remarks No reference is added, so returned name should not be kept.
+		*/
+		CKSTRING FindInternedName(CKSTRING name);
+		/**
+		 * @brief Convert interned name to ordinary string.
+		 * @param[in] interned_name The name returned by InternName(). nullptr is not allowed.
+		 * @param[out] native_name The output ordinary string.
+		 * @return True if convertion is success, otherwise false.
+		 * @remarks
+		 * Same as GetOrdinaryString(), but the result is cached in pool,
+		 * so each name is converted only once until encoding sequence is changed.
+		*/
+		bool GetOrdinaryName(CKSTRING interned_name, std::string& native_name);
+
+	protected:
+		/**
+		 * @brief The entry of interned name.
+		*/
+		struct InternedName {
+			XContainer::XString m_Name;
+			CKDWORD m_RefCount; /**< The count of InternName() calls which are not released. */
+			std::string m_OrdinaryName; /**< The cached ordinary string of this name. */
+			bool m_HasOrdinaryName; /**< True if m_OrdinaryName is computed by current encoding sequence. */
+			bool m_IsOrdinaryNameValid; /**< The convertion result of m_OrdinaryName. */
+		};
+		/**
+		 * @brief The name pool. The key is the view of m_Name in its value.
+		*/
+		XContainer::XHashTable<std::u8string_view, std::unique_ptr<InternedName>> m_NamePool;
+		std::mutex m_NamePoolMutex;
 
 		// ========== Print utilities ==========
 	public:
@@ -176,6 +338,7 @@ namespace LibCmo::CK2 {
 
 	protected:
 		OutputCallback m_OutputCallback;
+		std::mutex m_OutputMutex; /**< The mutex making sure that callback is called serially. */
 	};
 
 }
@@ -25,6 +25,19 @@ namespace LibCmo::CK2 {
 		CKFILE_WHOLECOMPRESSED = 8,	/**< Compress the whole file  */
 	};
 	/**
+	@brief Specify how the CRC of file is verified when loading file.
+	@remark
+		+ This is not a Virtools option. It is introduced by LibCmo.
+		+ Verifying CRC need an extra pass over the whole file.
+		Pipelines which have already verified files in other ways can skip it.
+	@see CKContext::SetFileCrcVerifyMode, CKContext::GetFileCrcVerifyMode
+	 */
+	enum class CK_FILE_CRCVERIFYMODE : CKDWORD {
+		CKFILE_CRC_VERIFY = 0,	/**< Verify CRC before parsing file. Loading fails if CRC is mismatched. */
+		CKFILE_CRC_VERIFYINBACKGROUND = 1,	/**< Verify CRC in background thread while parsing file. Mismatched CRC is reported through output callback only. */
+		CKFILE_CRC_SKIP = 2,	/**< Do not verify CRC. */
+	};
+	/**
 	Load Options.
 	@remark
 		+ This options apply when loading a Virtools file
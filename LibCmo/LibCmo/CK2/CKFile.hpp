@@ -2,6 +2,9 @@
 
 #include "../VTInternal.hpp"
 #include <yycc/macro/class_copy_move.hpp>
+#include <memory>
+#include <functional>
+#include <thread>
 
 namespace LibCmo::XContainer {
 	using XIntArray = XArray<CKINT>;
@@ -128,7 +131,12 @@ namespace LibCmo::CK2 {
 		CK_ID CreatedObjectId; /**< ID of the object being created */
 		CK_CLASSID ObjectCid; /**< Class Identifier of the object */
 		ObjImpls::CKObject* ObjPtr; /**< A pointer to the object itself (as CreatedObject when loading) */
-		XContainer::XString Name; /**< Name of the Object */
+		/**
+		 * @brief Name of the Object. It is interned in CKContext, or nullptr if the object has no name.
+		 * @remarks The reader or writer holding this object owns one reference of this name,
+		 * so it is valid until that reader or writer is destroyed.
+		*/
+		CKSTRING Name;
 		CKStateChunk* Data; /**< A CKStateChunk that contains object information */
 		CKDWORD PackSize;  /**< The CKStateChunk data size */
 		//CKINT PostPackSize; /**< When compressed chunk by chunk : size of Data after compression */
@@ -167,6 +175,16 @@ namespace LibCmo::CK2 {
 	public:
 		CKFileVisitor(CKFileReader* reader);
 		CKFileVisitor(CKFileWriter* writer);
+		/**
+		 * @brief Create a writer visitor which defers added files.
+		 * @param[in] writer The writer.
+		 * @param[in] deferred_files The list receiving the files added by AddSavedFile().
+		 * @details
+		 * This visitor is used when serializing objects in worker threads.
+		 * The files added through it will not be added into writer directly,
+		 * but pushed into given list, and the caller add them into writer later in caller thread.
+		*/
+		CKFileVisitor(CKFileWriter* writer, XContainer::XArray<XContainer::XString>* deferred_files);
 		CKFileVisitor(const CKFileVisitor&);
 		CKFileVisitor(CKFileVisitor&&);
 		CKFileVisitor& operator=(const CKFileVisitor&);
@@ -175,14 +193,48 @@ namespace LibCmo::CK2 {
 		const CKFileObject* GetFileObjectByIndex(CKDWORD index);
 		CKDWORD GetIndexByObjectID(CK_ID objid);
 		bool AddSavedFile(CKSTRING u8FileName);
+		/**
+		 * @brief Register bitmap data which has images whose decoding is deferred.
+		 * @param[in] bmp The bitmap data owned by currently loading object. nullptr is not allowed.
+		 * @return True if reader will decode its images before DeepLoad() returns.
+		 * Always false for writer, or the reader which do not decode images in DeepLoad().
+		 * @remarks Called by CKBitmapData::ReadFromChunk().
+		 * The images not decoded by reader will be decoded when they are accessed.
+		*/
+		bool AddPendingBitmap(CKBitmapData* bmp);
 
 	protected:
 		bool m_IsReader;
 		CKFileReader* m_Reader;
 		CKFileWriter* m_Writer;
 		CKContext* m_Ctx;
+		XContainer::XArray<XContainer::XString>* m_DeferredSavedFiles;
 	};
 
+	/**
+	 * @brief The callback providing the data of loaded file.
+	 * @details
+	 * It accept a buffer and the size of this buffer,
+	 * and return the count of bytes written into given buffer.
+	 * Returning zero means that there is no more data.
+	*/
+	using CKFileSourceCallback = std::function<CKDWORD(void*, CKDWORD)>;
+	/**
+	 * @brief The callback receiving the data of saved file.
+	 * @details
+	 * It accept a pointer to data and the size of data.
+	 * Return true if all given data is written, otherwise false.
+	*/
+	using CKFileSinkCallback = std::function<bool(const void*, CKDWORD)>;
+	/**
+	 * @brief The callback overwriting the data which has been given to CKFileSinkCallback.
+	 * @details
+	 * It accept the offset from the start of saved file, a pointer to data and the size of data.
+	 * The overwritten range never exceeds the data which has been written.
+	 * Return true if all given data is written, otherwise false.
+	*/
+	using CKFilePatchCallback = std::function<bool(CKDWORD, const void*, CKDWORD)>;
+
 	class CKFileReader {
 		friend class CKFileVisitor;
 	public:
@@ -193,6 +245,96 @@ namespace LibCmo::CK2 {
 		// ========== Loading ==========
 		CKERROR ShallowLoad(CKSTRING u8_filename);
 		CKERROR DeepLoad(CKSTRING u8_filename);
+		/**
+		 * @brief Load file from memory buffer.
+		 * @param[in] buf The buffer holding the whole file. nullptr is not allowed.
+		 * @param[in] size The size of buffer.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks
+		 * Loaded CKStateChunk borrow their data from given buffer,
+		 * so given buffer must be kept until this reader is destroyed.
+		*/
+		CKERROR ShallowLoad(const void* buf, CKDWORD size);
+		/**
+		 * @brief Load file from memory buffer.
+		 * @param[in] buf The buffer holding the whole file. nullptr is not allowed.
+		 * @param[in] size The size of buffer.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks Same as ShallowLoad(const void*, CKDWORD), given buffer must be kept until this reader is destroyed.
+		*/
+		CKERROR DeepLoad(const void* buf, CKDWORD size);
+		/**
+		 * @brief Load file from custom source.
+		 * @param[in] source The callback providing file data. nullptr is not allowed.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks All data will be read from source and kept by this reader before loading.
+		*/
+		CKERROR ShallowLoad(CKFileSourceCallback source);
+		/**
+		 * @brief Load file from custom source.
+		 * @param[in] source The callback providing file data. nullptr is not allowed.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks All data will be read from source and kept by this reader before loading.
+		*/
+		CKERROR DeepLoad(CKFileSourceCallback source);
+
+		/**
+		 * @brief Read the header of file only.
+		 * @param[in] u8_filename The path to file.
+		 * @param[in] verify_crc True to check the CRC of whole file.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks
+		 * \li Only file info, object list (id, class id and name), plugin dependencies
+		 * and the count of included files are read. They can be fetched by GetFileInfo(), GetFileObjects() and etc.
+		 * No CKStateChunk is loaded, so GetManagersData() is empty and CKFileObject::Data is always nullptr.
+		 * \li If CRC is not checked, only the file header and header part will be read from file,
+		 * except the file whose FileVersion < 8 which need to be read fully because its header part has no size.
+		 * \li The CRC of file whose FileVersion < 8 is only computed for data part and will not be checked here.
+		 * \li Like ShallowLoad(), this reader is done after calling this function.
+		*/
+		CKERROR ProbeHeader(CKSTRING u8_filename, bool verify_crc = false);
+		/**
+		 * @brief Read the header of file stored in memory buffer only.
+		 * @param[in] buf The buffer holding file. nullptr is not allowed.
+		 * @param[in] size The size of buffer. If CRC is not checked, the buffer can only hold file header and header part.
+		 * @param[in] verify_crc True to check the CRC of whole file.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks See ProbeHeader(CKSTRING, bool) for more info.
+		*/
+		CKERROR ProbeHeader(const void* buf, CKDWORD size, bool verify_crc = false);
+
+		// ========== Loading Options ==========
+		/**
+		 * @brief Set the class filter applied when deep loading.
+		 * @param[in] cids The allowed class ids. Their derived classes are also allowed.
+		 * Empty list to remove filter and load all objects.
+		 * @remarks
+		 * \li The classes which allowed classes depend on are also allowed, for example,
+		 * the materials used by meshes and the textures used by materials.
+		 * See CKGetLoadDependencyClassID() for how dependency is resolved.
+		 * \li The objects whose class is not allowed will not be created in DeepLoad().
+		 * Their CKStateChunk will be kept unparsed in GetFileObjects() like ShallowLoad() does.
+		*/
+		void SetDeepLoadClassFilter(const XContainer::XArray<CK_CLASSID>& cids);
+		/**
+		 * @brief Set whether the CKStateChunk of objects is kept after they are loaded in DeepLoad().
+		 * @param[in] keep True to keep them. Default is false.
+		 * @remarks
+		 * \li The kept CKStateChunk can be fetched by GetFileObjects() after DeepLoad().
+		 * \li CKFileWriter created from this reader reuses the kept CKStateChunk of unmodified objects,
+		 * instead of saving these objects again. See CKObject::IsDirty() for more info.
+		*/
+		void SetKeepObjectChunks(bool keep);
+		/**
+		 * @brief Set whether the images embedded in textures are decoded in DeepLoad().
+		 * @param[in] decode True to decode them. Default is false.
+		 * @remarks
+		 * \li If enabled, images are decoded by multiple worker threads before DeepLoad() returns.
+		 * It is faster when the pixels of most textures will be accessed.
+		 * \li Otherwise, images are decoded when their pixels are accessed at the first time,
+		 * and the unmodified images are written back without encoding. See CKBitmapData::DecodePendingImages().
+		*/
+		void SetDecodeImages(bool decode);
 
 		// ========== Loading Result ==========
 		CK_ID GetSaveIdMax();
@@ -215,9 +357,78 @@ namespace LibCmo::CK2 {
 		*/
 		XContainer::XArray<XContainer::XString> m_IncludedFiles;
 		CKFileInfo m_FileInfo; /**< Headers summary */
+		bool m_IsClassFiltered; /**< True if DeepLoad() only load the objects allowed by m_DeepLoadClassFilter. */
+		XContainer::XBitArray m_DeepLoadClassFilter; /**< The class ids allowed to be loaded by DeepLoad(), including dependencies. */
+		bool m_KeepObjectChunks; /**< True if DeepLoad() keeps the CKStateChunk of loaded objects. */
+		bool m_DecodeImages; /**< True if DeepLoad() decodes the images embedded in textures before returning. */
+		/**
+		 * @brief The index of CKFileObject which is being loaded in DeepLoad().
+		 * @details It is used to bind pending bitmap to its owner object.
+		*/
+		CKDWORD m_LoadingObjectIndex;
+		/**
+		 * @brief The bitmap data whose images are decoded in worker threads at the end of DeepLoad().
+		 * @details Each item is the index of owner object in m_FileObjects and the bitmap data.
+		 * The bitmap of the object destroyed during loading is skipped.
+		*/
+		XContainer::XArray<std::pair<CKDWORD, CKBitmapData*>> m_PendingBitmaps;
 
-		CKERROR ReadFileHeader(CKBufferParser* ParserPtr);
+		/**
+		 * @brief Load file header and data from given buffer.
+		 * @details Called by all ShallowLoad() overloads after the whole file is ready in memory.
+		 * @param[in] buf The buffer holding the whole file.
+		 * @param[in] size The size of buffer.
+		 * @return CKERROR::CKERR_OK if success.
+		*/
+		CKERROR InternalShallowLoad(const void* buf, CKDWORD size);
+		/**
+		 * @brief Create and load objects from shallow loaded file.
+		 * @details Called by all DeepLoad() overloads after calling ShallowLoad().
+		 * @return CKERROR::CKERR_OK if success.
+		*/
+		CKERROR InternalDeepLoad();
+		/**
+		 * @brief Read file header.
+		 * @param[in] ParserPtr The parser of file. Its cursor will be moved to the start of data part.
+		 * @param[in] CrcMode The way to verify CRC of file (FileVersion >= 8 only).
+		 * @param[in] HeaderOnly True if only file header and header part will be read (for ProbeHeader()).
+		 * If it is true and CrcMode is CK_FILE_CRCVERIFYMODE::CKFILE_CRC_SKIP, only the header part is required in given parser.
+		 * Otherwise the data part must be located in given parser, because it will be read by ReadFileData() or CRC verifier.
+		 * @return CKERROR::CKERR_OK if success.
+		*/
+		CKERROR ReadFileHeader(CKBufferParser* ParserPtr, CK_FILE_CRCVERIFYMODE CrcMode, bool HeaderOnly);
 		CKERROR ReadFileData(CKBufferParser* ParserPtr);
+		/**
+		 * @brief Verify CRC of file in given way.
+		 * @param[in] CrcMode The way to verify CRC.
+		 * @param[in] Checker The function computing CRC and return true if it is matched.
+		 * In background mode, it will be executed in another thread,
+		 * so it should only access the data kept until this reader is destroyed.
+		 * @return CKERROR::CKERR_FILECRCERROR if CRC is verified in caller thread and mismatched, otherwise CKERROR::CKERR_OK.
+		*/
+		CKERROR VerifyFileCrc(CK_FILE_CRCVERIFYMODE CrcMode, std::function<bool()> Checker);
+
+		/**
+		 * @brief The mapped file of loaded file.
+		 * @details The CKStateChunk of loaded objects and managers borrow their data from this buffer,
+		 * so it should be kept until this reader is destroyed.
+		*/
+		std::unique_ptr<VxMath::VxMemoryMappedFile> m_MappedFile;
+		/**
+		 * @brief The data of loaded file read from custom source.
+		 * @details Same as m_MappedFile, but used when loading file from custom source.
+		*/
+		XContainer::XArray<CKBYTE> m_SourceData;
+		/**
+		 * @brief The decompressed data part of loaded file.
+		 * @details Same as m_MappedFile, but used when data part of loaded file is compressed.
+		*/
+		std::unique_ptr<CKBYTE[]> m_UnPackedData;
+		/**
+		 * @brief The thread verifying CRC in background.
+		 * @details It reads file buffers, so it is joined before any file buffers are freed.
+		*/
+		std::thread m_CrcVerifier;
 
 		CKContext* m_Ctx;
 		CKFileVisitor m_Visitor;
@@ -236,8 +447,61 @@ namespace LibCmo::CK2 {
 		bool AddSavedObjects(const XContainer::XObjectPointerArray& objarray, CKDWORD flags = CK_STATESAVE_ALL);
 		bool AddSavedFile(CKSTRING u8FileName);
 
+		// ========== Saving Options ==========
+		/**
+		 * @brief Set whether Save(CKSTRING) replaces the destination file atomically.
+		 * @param[in] atomic True to enable atomic saving. Default is false.
+		 * @remarks
+		 * \li In atomic mode, file is written into a temporary file located beside the destination file first,
+		 * (the name of destination file with a unique \c .<pid>.<counter>.tmp suffix, created exclusively),
+		 * then the temporary file is flushed to disk, and renamed to the destination file.
+		 * The destination file is never touched if saving failed.
+		 * \li Concurrent atomic saves to the same destination never share their temporary files.
+		 * The last renamed one wins.
+		 * \li The destination file is replaced by a new file, so the program which is reading or mapping old file is not affected.
+		 * The permissions of existing destination file are copied to the new file.
+		 * \li The temporary file will be removed if saving failed, including failing by exception.
+		*/
+		void SetAtomicSave(bool atomic);
+
 		// ========== Saving ==========
+		/**
+		 * @brief Save file into given path.
+		 * @param[in] u8_filename The path to file.
+		 * @return CKERROR::CKERR_OK if success.
+		 * @remarks
+		 * \li In default mode, the destination file is opened when writing the first piece of data,
+		 * and data is written into it progressively. So if saving failed after that,
+		 * the original content of destination file is lost, and the partially written file is removed.
+		 * \li Enable atomic saving by SetAtomicSave() to keep destination file untouched when saving failed.
+		*/
 		CKERROR Save(CKSTRING u8_filename);
+		/**
+		 * @brief Save file into custom sink.
+		 * @param[in] sink The callback receiving file data in order. nullptr is not allowed.
+		 * @return CKERROR::CKERR_OK if success. CKERROR::CKERR_CANTWRITETOFILE if sink failed.
+		 * @remarks
+		 * The header of file need to be overwritten after writing data part,
+		 * so the whole file is built in memory before passing to sink.
+		 * Use Save(CKFileSinkCallback, CKFilePatchCallback) if the output can be overwritten.
+		*/
+		CKERROR Save(CKFileSinkCallback sink);
+		/**
+		 * @brief Save file into custom sink which can be overwritten.
+		 * @param[in] sink The callback receiving file data in order. nullptr is not allowed.
+		 * @param[in] patcher The callback overwriting written data. nullptr is not allowed.
+		 * @return CKERROR::CKERR_OK if success. CKERROR::CKERR_CANTWRITETOFILE if sink or patcher failed.
+		 * @remarks
+		 * Data part is written (and compressed) object by object without building it in memory.
+		 * The file header is written with placeholder first, then overwritten with final size and CRC by patcher.
+		*/
+		CKERROR Save(CKFileSinkCallback sink, CKFilePatchCallback patcher);
+		/**
+		 * @brief Save file into memory buffer.
+		 * @param[out] buffer The buffer receiving the whole file. Its original content will be cleared.
+		 * @return CKERROR::CKERR_OK if success.
+		*/
+		CKERROR Save(XContainer::XArray<CKBYTE>& buffer);
 
 	protected:
 		/**
@@ -246,6 +510,14 @@ namespace LibCmo::CK2 {
 		 * @return CKERROR::CK_OK if can write.
 		*/
 		CKERROR PrepareFile(CKSTRING filename);
+		/**
+		 * @brief Serialize all saved objects and write file into given sink.
+		 * @details Called by all Save() overloads after checking writer status.
+		 * @param[in] sink The callback receiving file data.
+		 * @param[in] patcher The callback overwriting file header after data part is written.
+		 * @return CKERROR::CKERR_OK if success.
+		*/
+		CKERROR InternalSave(CKFileSinkCallback& sink, CKFilePatchCallback& patcher);
 		/**
 		 * @brief Internal used Object Adder.
 		 * @details
@@ -274,8 +546,14 @@ namespace LibCmo::CK2 {
 		 * \li This field usually be set when importing from reader.
 		*/
 		bool m_DisableAddingFile;
+		bool m_IsAtomicSave; /**< True if Save(CKSTRING) writes into temporary file and renames it to destination. */
 		
 		CK_ID m_SaveIDMax; /**< Maximum CK_ID found when saving or loading objects */
+		/**
+		 * @brief The pool providing write buffer for CKStateChunk created in saving.
+		 * @remarks It must be declared before m_FileObjects and m_ManagersData, so that it will be destroyed after them.
+		*/
+		std::unique_ptr<CKStateChunkBufferPool> m_ChunkBufferPool;
 		XContainer::XArray<CKFileObject> m_FileObjects; /**< List of objects being saved / loaded */
 		XContainer::XArray<CKFileManagerData> m_ManagersData; /**< Manager Data loaded */
 		XContainer::XArray<CKFilePluginDependencies> m_PluginsDep;	/**< Plugins dependencies for this file */
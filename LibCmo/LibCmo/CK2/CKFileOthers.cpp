@@ -2,7 +2,9 @@
 #include "CKStateChunk.hpp"
 #include "CKContext.hpp"
 #include "MgrImpls/CKPathManager.hpp"
+#include "MgrImpls/CKObjectManager.hpp"
 #include "ObjImpls/CKObject.hpp"
+#include "../VxMath/VxMemoryMappedFile.hpp"
 #include <cstdarg>
 
 namespace LibCmo::CK2 {
@@ -15,7 +17,7 @@ namespace LibCmo::CK2 {
 
 	CKFileObject::CKFileObject() :
 		ObjectId(0u), CreatedObjectId(0u), ObjectCid(CK_CLASSID::CKCID_OBJECT),
-		ObjPtr(nullptr), Name(), Data(nullptr), Options(CK_FO_OPTIONS::CK_FO_DEFAULT),
+		ObjPtr(nullptr), Name(nullptr), Data(nullptr), Options(CK_FO_OPTIONS::CK_FO_DEFAULT),
 		FileIndex(0u), SaveFlags(CK_STATESAVE_ALL), PackSize(0u) {}
 
 	CKFileObject::CKFileObject(const CKFileObject& rhs) :
@@ -130,9 +132,22 @@ namespace LibCmo::CK2 {
 		m_Done(false),
 		m_SaveIDMax(0),
 		m_FileObjects(), m_ManagersData(), m_PluginsDep(), m_IncludedFiles(),
-		m_FileInfo() {}
-
-	CKFileReader::~CKFileReader() {}
+		m_FileInfo(),
+		m_IsClassFiltered(false), m_DeepLoadClassFilter(), m_KeepObjectChunks(false), m_DecodeImages(false),
+		m_LoadingObjectIndex(0), m_PendingBitmaps(),
+		m_MappedFile(nullptr), m_SourceData(), m_UnPackedData(nullptr), m_CrcVerifier() {}
+
+	CKFileReader::~CKFileReader() {
+		// wait background CRC verifier, because it read file buffers.
+		if (this->m_CrcVerifier.joinable()) this->m_CrcVerifier.join();
+		// free all CKStateChunk first, because they may borrow data from file buffers.
+		// and release the names held by file objects.
+		for (const auto& obj : this->m_FileObjects) {
+			this->m_Ctx->ReleaseName(obj.Name);
+		}
+		this->m_FileObjects.clear();
+		this->m_ManagersData.clear();
+	}
 
 	CK_ID CKFileReader::GetSaveIdMax() {
 		return m_SaveIDMax;
@@ -165,8 +180,9 @@ namespace LibCmo::CK2 {
 	CKFileWriter::CKFileWriter(CKContext* ctx) :
 		m_Ctx(ctx), m_Visitor(this),
 		m_Done(false),
-		m_DisableAddingObject(false), m_DisableAddingFile(false),
+		m_DisableAddingObject(false), m_DisableAddingFile(false), m_IsAtomicSave(false),
 		m_SaveIDMax(0),
+		m_ChunkBufferPool(std::make_unique<CKStateChunkBufferPool>()),
 		m_FileObjects(), m_ManagersData(), m_PluginsDep(), m_IncludedFiles(),
 		m_FileInfo()
 	{}
@@ -175,7 +191,9 @@ namespace LibCmo::CK2 {
 		m_Ctx(ctx), m_Visitor(this),
 		m_Done(false),
 		m_DisableAddingObject(true), m_DisableAddingFile(is_shallow),	// only disable adding file in shallow mode. but disable adding object in all mode.
+		m_IsAtomicSave(false),
 		m_SaveIDMax(0),
+		m_ChunkBufferPool(std::make_unique<CKStateChunkBufferPool>()),
 		m_FileObjects(), m_ManagersData(), m_PluginsDep(), m_IncludedFiles(),
 		m_FileInfo()
 	{
@@ -202,7 +220,8 @@ namespace LibCmo::CK2 {
 				obj.CreatedObjectId = 0;
 				obj.ObjectCid = item.ObjectCid;
 				obj.ObjPtr = nullptr;	// set zero for obj
-				obj.Name = item.Name;
+				// the reader may belong to another context, so intern it again.
+				obj.Name = m_Ctx->InternName(item.Name);
 				obj.SaveFlags = item.SaveFlags;
 
 				// insert
@@ -244,15 +263,38 @@ namespace LibCmo::CK2 {
 
 #pragma region Deep Assign
 
-			// call internal object adder one by one
-			for (const auto& item : reader->GetFileObjects()) {
-				CKFileObject obj;
+			// check whether the loaded CKStateChunk can be reused.
+			// the object references in CKStateChunk are written as the index of file objects,
+			// so they are only valid if all objects are kept and located at the same index with reader.
+			const auto& fileObjects = reader->GetFileObjects();
+			bool reusable = true;
+			for (const auto& item : fileObjects) {
+				if (item.ObjPtr == nullptr || m_Ctx->GetObject(item.CreatedObjectId) != item.ObjPtr) {
+					reusable = false;
+					break;
+				}
+			}
 
+			// call internal object adder one by one
+			for (const auto& item : fileObjects) {
 				// skip if invalid
 				if (item.ObjPtr == nullptr) continue;
 
 				// try add
-				InternalObjectAdder(item.ObjPtr);
+				if (!InternalObjectAdder(item.ObjPtr)) reusable = false;
+			}
+
+			// reuse the chunk of unmodified objects.
+			// writer will not save the object which already has chunk.
+			// only the chunk in current layout can be reused. older chunks store object id instead of file index.
+			if (reusable) {
+				for (size_t i = 0; i < fileObjects.size(); ++i) {
+					const auto& item = fileObjects[i];
+					if (item.Data == nullptr || item.ObjPtr->IsDirty()) continue;
+					if (item.Data->GetChunkVersion() != CK_STATECHUNK_CHUNKVERSION::CHUNK_VERSION4) continue;
+
+					m_FileObjects[i].Data = new CKStateChunk(*item.Data);
+				}
 			}
 
 #pragma endregion
@@ -260,28 +302,36 @@ namespace LibCmo::CK2 {
 		}
 	}
 
-	CKFileWriter::~CKFileWriter() {}
+	CKFileWriter::~CKFileWriter() {
+		// release the names held by file objects.
+		for (const auto& obj : this->m_FileObjects) {
+			this->m_Ctx->ReleaseName(obj.Name);
+		}
+	}
 
 	bool CKFileWriter::InternalObjectAdder(ObjImpls::CKObject * obj, CKDWORD flags) {
 		if (obj == nullptr) return false;
 
 		// check whether is saved.
+		// use the CK_ID without generation for saving, because it is small and still unique.
 		CK_ID objid = obj->GetID();
-		if (XContainer::NSXBitArray::IsSet(m_AlreadySavedMask, static_cast<CKDWORD>(objid))) return false;
+		CK_ID savedid = MgrImpls::CKObjectManager::GetSavedObjectId(objid);
+		if (XContainer::NSXBitArray::IsSet(m_AlreadySavedMask, static_cast<CKDWORD>(savedid))) return false;
 
 		// ok, insert this value
 		m_ObjectsHashTable.try_emplace(objid, static_cast<CKDWORD>(m_FileObjects.size()));
-		XContainer::NSXBitArray::Set(m_AlreadySavedMask, static_cast<CKDWORD>(objid));
+		XContainer::NSXBitArray::Set(m_AlreadySavedMask, static_cast<CKDWORD>(savedid));
 		// update max id
-		m_SaveIDMax = std::max(m_SaveIDMax, objid);
+		m_SaveIDMax = std::max(m_SaveIDMax, savedid);
 
 		// add entry
 		CKFileObject fobj;
-		fobj.ObjectId = objid;
+		fobj.ObjectId = savedid;
 		fobj.ObjPtr = obj;
 		fobj.ObjectCid = obj->GetClassID();
 		fobj.SaveFlags = flags;
-		XContainer::NSXString::FromCKSTRING(fobj.Name, obj->GetName());
+		// hold a reference, because object may be renamed before saving.
+		fobj.Name = m_Ctx->InternName(obj->GetName());
 		m_FileObjects.emplace_back(std::move(fobj));
 		
 		return true;
@@ -316,32 +366,43 @@ namespace LibCmo::CK2 {
 		return true;
 	}
 
+	void CKFileWriter::SetAtomicSave(bool atomic) {
+		m_IsAtomicSave = atomic;
+	}
+
 #pragma endregion
 
 
 #pragma region CKFileVisitor
 
 	CKFileVisitor::CKFileVisitor(CKFileReader* reader) :
-		m_IsReader(true), m_Reader(reader), m_Writer(nullptr), m_Ctx(reader->m_Ctx) {
+		m_IsReader(true), m_Reader(reader), m_Writer(nullptr), m_Ctx(reader->m_Ctx), m_DeferredSavedFiles(nullptr) {
 		if (reader == nullptr) throw LogicException("Reader is nullptr.");
 	}
 
 	CKFileVisitor::CKFileVisitor(CKFileWriter* writer) :
-		m_IsReader(false), m_Reader(nullptr), m_Writer(writer), m_Ctx(writer->m_Ctx) {
+		m_IsReader(false), m_Reader(nullptr), m_Writer(writer), m_Ctx(writer->m_Ctx), m_DeferredSavedFiles(nullptr) {
+		if (writer == nullptr) throw LogicException("Writer is nullptr.");
+	}
+
+	CKFileVisitor::CKFileVisitor(CKFileWriter* writer, XContainer::XArray<XContainer::XString>* deferred_files) :
+		m_IsReader(false), m_Reader(nullptr), m_Writer(writer), m_Ctx(writer->m_Ctx), m_DeferredSavedFiles(deferred_files) {
 		if (writer == nullptr) throw LogicException("Writer is nullptr.");
+		if (deferred_files == nullptr) throw LogicException("Deferred file list is nullptr.");
 	}
 
 	CKFileVisitor::CKFileVisitor(const CKFileVisitor& rhs) :
-		m_IsReader(rhs.m_IsReader), m_Reader(rhs.m_Reader), m_Writer(rhs.m_Writer), m_Ctx(rhs.m_Ctx) {}
+		m_IsReader(rhs.m_IsReader), m_Reader(rhs.m_Reader), m_Writer(rhs.m_Writer), m_Ctx(rhs.m_Ctx), m_DeferredSavedFiles(rhs.m_DeferredSavedFiles) {}
 
 	CKFileVisitor::CKFileVisitor(CKFileVisitor&& rhs) :
-		m_IsReader(rhs.m_IsReader), m_Reader(rhs.m_Reader), m_Writer(rhs.m_Writer), m_Ctx(rhs.m_Ctx) {}
+		m_IsReader(rhs.m_IsReader), m_Reader(rhs.m_Reader), m_Writer(rhs.m_Writer), m_Ctx(rhs.m_Ctx), m_DeferredSavedFiles(rhs.m_DeferredSavedFiles) {}
 
 	CKFileVisitor& CKFileVisitor::operator=(const CKFileVisitor& rhs) {
 		this->m_IsReader = rhs.m_IsReader;
 		this->m_Reader = rhs.m_Reader;
 		this->m_Writer = rhs.m_Writer;
 		this->m_Ctx = rhs.m_Ctx;
+		this->m_DeferredSavedFiles = rhs.m_DeferredSavedFiles;
 
 		return *this;
 	}
@@ -351,6 +412,7 @@ namespace LibCmo::CK2 {
 		this->m_Reader = rhs.m_Reader;
 		this->m_Writer = rhs.m_Writer;
 		this->m_Ctx = rhs.m_Ctx;
+		this->m_DeferredSavedFiles = rhs.m_DeferredSavedFiles;
 
 		return *this;
 	}
@@ -376,11 +438,25 @@ namespace LibCmo::CK2 {
 	bool CKFileVisitor::AddSavedFile(CKSTRING u8FileName) {
 		if (m_IsReader) {
 			return false;
+		} else if (m_DeferredSavedFiles != nullptr) {
+			// check it like writer does, but push it into deferred list.
+			if (m_Writer->m_Done || m_Writer->m_DisableAddingFile) return false;
+			if (u8FileName == nullptr) return false;
+			m_DeferredSavedFiles->emplace_back(u8FileName);
+			return true;
 		} else {
 			return m_Writer->AddSavedFile(u8FileName);
 		}
 	}
 
+	bool CKFileVisitor::AddPendingBitmap(CKBitmapData* bmp) {
+		if (bmp == nullptr) throw LogicException("Bitmap data is nullptr.");
+		if (!m_IsReader || !m_Reader->m_DecodeImages) return false;
+
+		m_Reader->m_PendingBitmaps.emplace_back(std::make_pair(m_Reader->m_LoadingObjectIndex, bmp));
+		return true;
+	}
+
 #pragma endregion
 
 }
@@ -4,12 +4,24 @@
 #include "MgrImpls/CKPathManager.hpp"
 #include "../VxMath/VxMemoryMappedFile.hpp"
 #include "CKContext.hpp"
+#include "CKBitmapData.hpp"
 #include <yycc/cenum.hpp>
 #include <yycc/patch/fopen.hpp>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <limits>
+#include <filesystem>
+#include <system_error>
 
 namespace LibCmo::CK2 {
 
+	/**
+	 * @brief The size of decompression window when reading compressed file progressively.
+	*/
+	static constexpr CKDWORD c_UnPackWindowSize = 1024u * 1024u;
+
 	/*
 	* NOTE:
 	* We onlt support read Virtools file with FileVersion >= 7.
@@ -25,15 +37,187 @@ namespace LibCmo::CK2 {
 
 		// check file and open memory
 		if (u8_filename == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+		// mapped file is kept by reader because loaded CKStateChunk will borrow data from it.
+		this->m_MappedFile.reset(new VxMath::VxMemoryMappedFile(u8_filename));
+		if (!this->m_MappedFile->IsValid()) {
+			this->m_Ctx->OutputToConsoleEx(u8"Fail to create Memory File for \"%s\".", u8_filename);
+			return CKERROR::CKERR_INVALIDFILE;
+		}
+
+		return this->InternalShallowLoad(this->m_MappedFile->GetBase(), this->m_MappedFile->GetFileSize());
+	}
+
+	CKERROR CKFileReader::ShallowLoad(const void* buf, CKDWORD size) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check buffer
+		if (buf == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		return this->InternalShallowLoad(buf, size);
+	}
+
+	CKERROR CKFileReader::ShallowLoad(CKFileSourceCallback source) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check source
+		if (source == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		// read all data from source.
+		// data is kept by reader because loaded CKStateChunk will borrow data from it.
+		constexpr size_t c_MinReadSize = 64u * 1024u;
+		constexpr size_t c_MaxFileSize = static_cast<size_t>(std::numeric_limits<CKDWORD>::max());
+		size_t readSize = 0u;
+		this->m_SourceData.clear();
+		while (true) {
+			// enlarge buffer if it is full
+			if (readSize == this->m_SourceData.size()) {
+				if (readSize >= c_MaxFileSize) {
+					this->m_SourceData.clear();
+					this->m_Ctx->OutputToConsole(u8"The size of Virtools file provided by source is too large.");
+					return CKERROR::CKERR_INVALIDFILE;
+				}
+				this->m_SourceData.resize(std::min(c_MaxFileSize, std::max(c_MinReadSize, readSize * 2u)));
+			}
+
+			// read data
+			CKDWORD expected = static_cast<CKDWORD>(this->m_SourceData.size() - readSize);
+			CKDWORD gotten = source(this->m_SourceData.data() + readSize, expected);
+			if (gotten == 0u) break;
+			if (gotten > expected) throw LogicException("Source callback returns more data than requested.");
+			readSize += gotten;
+		}
+		this->m_SourceData.resize(readSize);
+
+		return this->InternalShallowLoad(this->m_SourceData.data(), static_cast<CKDWORD>(readSize));
+	}
+
+	CKERROR CKFileReader::ProbeHeader(CKSTRING u8_filename, bool verify_crc) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check file
+		if (u8_filename == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		// read file header and header part only if we don't need CRC.
+		if (!verify_crc) {
+			FILE* fs = yycc::patch::fopen::fopen(u8_filename, u8"rb");
+			if (fs == nullptr) {
+				this->m_Ctx->OutputToConsoleEx(u8"Fail to open file \"%s\".", u8_filename);
+				return CKERROR::CKERR_INVALIDFILE;
+			}
+
+			// get file size.
+			// use filesystem rather than ftell, because long is 32-bit in some platforms.
+			std::error_code ec;
+			std::uintmax_t fileSize = std::filesystem::file_size(std::filesystem::path(u8_filename), ec);
+			if (ec || fileSize < sizeof(CKRawFileInfo) || fileSize > static_cast<std::uintmax_t>(std::numeric_limits<CKDWORD>::max())) {
+				std::fclose(fs);
+				return CKERROR::CKERR_INVALIDFILE;
+			}
+
+			// read file header
+			XContainer::XArray<CKBYTE> headerData(sizeof(CKRawFileInfo));
+			if (std::fread(headerData.data(), sizeof(CKBYTE), headerData.size(), fs) != headerData.size()) {
+				std::fclose(fs);
+				return CKERROR::CKERR_INVALIDFILE;
+			}
+
+			// validate file header before trusting any size in it,
+			// otherwise a broken or non-Virtools file can make us allocate a huge buffer.
+			// these checks are the same as ReadFileHeader().
+			const CKRawFileInfo* rawHeader = reinterpret_cast<const CKRawFileInfo*>(headerData.data());
+			if (std::memcmp(rawHeader->NeMo, CKNEMOFI, sizeof(CKRawFileInfo::NeMo)) || rawHeader->Zero) {
+				std::fclose(fs);
+				return CKERROR::CKERR_INVALIDFILE;
+			}
+			if (rawHeader->FileVersion > 9 || rawHeader->FileVersion < 7) {
+				std::fclose(fs);
+				return CKERROR::CKERR_OBSOLETEVIRTOOLS;
+			}
+
+			// read header part.
+			// file whose FileVersion < 8 do not have the size of header part. read it fully in that case.
+			if (rawHeader->FileVersion >= 8) {
+				if (static_cast<std::uintmax_t>(rawHeader->Hdr1PackSize) > fileSize - sizeof(CKRawFileInfo)) {
+					std::fclose(fs);
+					return CKERROR::CKERR_INVALIDFILE;
+				}
+				size_t hdrSize = static_cast<size_t>(rawHeader->Hdr1PackSize);
+				headerData.resize(sizeof(CKRawFileInfo) + hdrSize);
+				if (std::fread(headerData.data() + sizeof(CKRawFileInfo), sizeof(CKBYTE), hdrSize, fs) != hdrSize) {
+					std::fclose(fs);
+					return CKERROR::CKERR_INVALIDFILE;
+				}
+				std::fclose(fs);
+
+				CKERROR err = this->ProbeHeader(headerData.data(), static_cast<CKDWORD>(headerData.size()), false);
+				// fix file size because we only read a part of file.
+				if (err == CKERROR::CKERR_OK) {
+					this->m_FileInfo.FileSize = static_cast<CKDWORD>(fileSize);
+				}
+				return err;
+			}
+			std::fclose(fs);
+		}
+
+		// map the whole file
 		std::unique_ptr<VxMath::VxMemoryMappedFile> mappedFile(new VxMath::VxMemoryMappedFile(u8_filename));
 		if (!mappedFile->IsValid()) {
 			this->m_Ctx->OutputToConsoleEx(u8"Fail to create Memory File for \"%s\".", u8_filename);
 			return CKERROR::CKERR_INVALIDFILE;
 		}
+		return this->ProbeHeader(mappedFile->GetBase(), mappedFile->GetFileSize(), verify_crc);
+	}
 
+	CKERROR CKFileReader::ProbeHeader(const void* buf, CKDWORD size, bool verify_crc) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check buffer
+		if (buf == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		// read header only.
+		// header reader copy all data it need, so no need to keep given buffer.
+		std::unique_ptr<CKBufferParser> parser(new CKBufferParser(buf, size, false));
+		CKERROR err = this->ReadFileHeader(parser.get(), verify_crc ? CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY : CK_FILE_CRCVERIFYMODE::CKFILE_CRC_SKIP, true);
+		if (err != CKERROR::CKERR_OK) return err;
+
+		// set done flag and return
+		this->m_Done = true;
+		return CKERROR::CKERR_OK;
+	}
+
+	void CKFileReader::SetDeepLoadClassFilter(const XContainer::XArray<CK_CLASSID>& cids) {
+		this->m_IsClassFiltered = !cids.empty();
+		if (this->m_IsClassFiltered) {
+			this->m_DeepLoadClassFilter = CKGetLoadDependencyClassID(cids);
+		} else {
+			this->m_DeepLoadClassFilter.clear();
+		}
+	}
+
+	void CKFileReader::SetKeepObjectChunks(bool keep) {
+		this->m_KeepObjectChunks = keep;
+	}
+
+	void CKFileReader::SetDecodeImages(bool decode) {
+		this->m_DecodeImages = decode;
+	}
+
+	CKERROR CKFileReader::InternalShallowLoad(const void* buf, CKDWORD size) {
 		// create buffer and start loading
-		std::unique_ptr<CKBufferParser> parser(new CKBufferParser(mappedFile->GetBase(), mappedFile->GetFileSize(), false));
-		CKERROR err = this->ReadFileHeader(parser.get());
+		std::unique_ptr<CKBufferParser> parser(new CKBufferParser(buf, size, false));
+		CKERROR err = this->ReadFileHeader(parser.get(), this->m_Ctx->GetFileCrcVerifyMode(), false);
 		if (err != CKERROR::CKERR_OK) return err;
 		err = this->ReadFileData(parser.get());
 		if (err != CKERROR::CKERR_OK) return err;
@@ -44,12 +228,10 @@ namespace LibCmo::CK2 {
 		return CKERROR::CKERR_OK;
 	}
 
-	CKERROR CKFileReader::ReadFileHeader(CKBufferParser* ParserPtr) {
+	CKERROR CKFileReader::ReadFileHeader(CKBufferParser* ParserPtr, CK_FILE_CRCVERIFYMODE CrcMode, bool HeaderOnly) {
 		std::unique_ptr<CKBufferParser> parser(new CKBufferParser(ParserPtr->GetBase(), ParserPtr->GetSize(), false));
 		parser->SetCursor(ParserPtr->GetCursor());
 
-		std::string name_conv;
-
 		// ========== read header ==========
 		// check header size
 		if (parser->GetSize() < CKSizeof(CKRawFileInfo)) return CKERROR::CKERR_INVALIDFILE;
@@ -85,20 +267,40 @@ namespace LibCmo::CK2 {
 		this->m_FileInfo.DataUnPackSize = rawHeader.DataUnPackSize;
 		this->m_FileInfo.Crc = rawHeader.Crc;
 
+		// ========== size checker ==========
+		// make sure that header part is located in buffer.
+		// data part also should be located in buffer if we need to check CRC or load it.
+		// only probing header without CRC can skip it.
+		if (this->m_FileInfo.FileVersion >= 8) {
+			CKQWORD expectedSize = static_cast<CKQWORD>(CKSizeof(CKRawFileInfo)) + this->m_FileInfo.Hdr1PackSize;
+			if (!HeaderOnly || CrcMode != CK_FILE_CRCVERIFYMODE::CKFILE_CRC_SKIP) expectedSize += this->m_FileInfo.DataPackSize;
+			if (expectedSize > static_cast<CKQWORD>(parser->GetSize())) return CKERROR::CKERR_INVALIDFILE;
+		}
+
 		// ========== crc and body unpacker ==========
 		if (this->m_FileInfo.FileVersion >= 8) {
-			// crc checker for file ver >= 8 
-			// reset crc field of header
+			// crc checker for file ver >= 8.
+			// it can be skipped, for example, when probing header.
+			// all data used by checker are located in file buffer which is kept until this reader is destroyed.
 			rawHeader.Crc = 0u;
+			const CKBYTE* hdrPtr = static_cast<const CKBYTE*>(parser->GetBase()) + CKSizeof(CKRawFileInfo);
+			CKDWORD hdrSize = this->m_FileInfo.Hdr1PackSize;
+			const CKBYTE* dataPtr = hdrPtr + hdrSize;
+			CKDWORD dataSize = this->m_FileInfo.DataPackSize;
+			CKDWORD expectedCrc = this->m_FileInfo.Crc;
+			// only use workers when verifying in caller thread. background verifier should not compete with parsing.
+			CKDWORD workers = CrcMode == CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY ? this->m_Ctx->GetWorkerThreadCount() : 1u;
+			CKERROR err = this->VerifyFileCrc(CrcMode, [rawHeader, hdrPtr, hdrSize, dataPtr, dataSize, expectedCrc, workers]() -> bool {
+				// Both CRC compute methods need the CRC of data part, which is the largest part of file.
+				// So we compute a standalone CRC of data part only once, and chain it after different previous CRC.
+				CKDWORD data_crc = CKComputeDataCRC(dataPtr, dataSize, 1u, workers);
+
+				// Compute and check CRC in theory (< Virtools 4.0)
+				CKDWORD gotten_crc = CKComputeDataCRC(&rawHeader, CKSizeof(CKRawFileInfo), 0u);
+				gotten_crc = CKComputeDataCRC(hdrPtr, hdrSize, gotten_crc);
+				gotten_crc = CKCombineDataCRC(gotten_crc, data_crc, dataSize);
+				if (gotten_crc == expectedCrc) return true;
 
-			// Compute and check CRC in theory (< Virtools 4.0)
-			CKDWORD gotten_crc = CKComputeDataCRC(&rawHeader, CKSizeof(CKRawFileInfo), 0u);
-			parser->SetCursor(CKSizeof(CKRawFileInfo));
-			gotten_crc = CKComputeDataCRC(parser->GetPtr(), this->m_FileInfo.Hdr1PackSize, gotten_crc);
-			parser->MoveCursor(this->m_FileInfo.Hdr1PackSize);
-			gotten_crc = CKComputeDataCRC(parser->GetPtr(), this->m_FileInfo.DataPackSize, gotten_crc);
-
-			if (gotten_crc != this->m_FileInfo.Crc) {
 				// MARK: 
 				// If the CRC check failed, there is another way to compute CRC. (>= Virtools 4.0)
 				// This is a patch for Dassault stupid programmer.
@@ -122,15 +324,12 @@ namespace LibCmo::CK2 {
 				// But they didn't find out what cause this bug, and just directly remove the whole of CRC checker to resolve this bug!
 				// I can't believe that this thing happens on such official software.
 				// This is the point which makes me indignant.
-				gotten_crc = CKComputeDataCRC(parser->GetPtr(), this->m_FileInfo.DataPackSize, 0u);
+				gotten_crc = CKCombineDataCRC(0u, data_crc, dataSize);
 
 				// Both CRC compute methods are failed. This file may be really broken.
-				// Report exception directly.
-				if (gotten_crc != this->m_FileInfo.Crc) {
-					this->m_Ctx->OutputToConsole(u8"Virtools file CRC error.");
-					return CKERROR::CKERR_FILECRCERROR;
-				}
-			}
+				return gotten_crc == expectedCrc;
+			});
+			if (err != CKERROR::CKERR_OK) return err;
 
 			// reset cursor
 			parser->SetCursor(CKSizeof(CKRawFileInfo));
@@ -153,7 +352,11 @@ namespace LibCmo::CK2 {
 			this->m_FileObjects.resize(this->m_FileInfo.ObjectCount);
 
 			// read data
-			for (auto& fileobj : this->m_FileObjects) {
+			// collect all names first and convert them in batch.
+			XContainer::XArray<std::string> native_names(this->m_FileInfo.ObjectCount);
+			for (CKDWORD i = 0; i < this->m_FileInfo.ObjectCount; ++i) {
+				auto& fileobj = this->m_FileObjects[i];
+
 				// read basic fields
 				parser->Read(&fileobj.ObjectId);
 				parser->Read(&fileobj.ObjectCid);
@@ -162,14 +365,18 @@ namespace LibCmo::CK2 {
 				CKDWORD namelen;
 				parser->Read(&namelen);
 				if (namelen != 0) {
-					name_conv.resize(namelen);
-					parser->Read(name_conv.data(), namelen);
-					if (!m_Ctx->GetUTF8String(name_conv, fileobj.Name))
-						m_Ctx->OutputToConsole(u8"Fail to get UTF8 name for CKObject when reading file header. Some objects name will leave to blank.");
-				} else {
-					XContainer::NSXString::FromCKSTRING(fileobj.Name, nullptr);
+					native_names[i].resize(namelen);
+					parser->Read(native_names[i].data(), namelen);
 				}
 			}
+
+			XContainer::XArray<XContainer::XString> u8_names;
+			if (!m_Ctx->GetUTF8Strings(native_names, u8_names))
+				m_Ctx->OutputToConsole(u8"Fail to get UTF8 name for CKObject when reading file header. Some objects name will leave to blank.");
+			for (CKDWORD i = 0; i < this->m_FileInfo.ObjectCount; ++i) {
+				// blank name is interned as nullptr
+				this->m_FileObjects[i].Name = m_Ctx->InternName(XContainer::NSXString::ToCKSTRING(u8_names[i]));
+			}
 		}
 
 		// ========== dep list read ==========
@@ -229,6 +436,32 @@ namespace LibCmo::CK2 {
 		return CKERROR::CKERR_OK;
 	}
 
+	CKERROR CKFileReader::VerifyFileCrc(CK_FILE_CRCVERIFYMODE CrcMode, std::function<bool()> Checker) {
+		switch (CrcMode) {
+			case CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY:
+				if (!Checker()) {
+					this->m_Ctx->OutputToConsole(u8"Virtools file CRC error.");
+					return CKERROR::CKERR_FILECRCERROR;
+				}
+				break;
+			case CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFYINBACKGROUND:
+			{
+				// there is only one verifier for each file. wait previous one for safety.
+				if (this->m_CrcVerifier.joinable()) this->m_CrcVerifier.join();
+				CKContext* ctx = this->m_Ctx;
+				this->m_CrcVerifier = std::thread([ctx, Checker]() -> void {
+					if (!Checker()) ctx->OutputToConsole(u8"Virtools file CRC error (detected by background verification).");
+				});
+				break;
+			}
+			case CK_FILE_CRCVERIFYMODE::CKFILE_CRC_SKIP:
+			default:
+				break;
+		}
+
+		return CKERROR::CKERR_OK;
+	}
+
 	CKERROR CKFileReader::ReadFileData(CKBufferParser* ParserPtr) {
 		std::unique_ptr<CKBufferParser> parser(new CKBufferParser(ParserPtr->GetBase(), ParserPtr->GetSize(), false));
 		parser->SetCursor(ParserPtr->GetCursor());
@@ -236,28 +469,40 @@ namespace LibCmo::CK2 {
 		std::string name_conv;
 
 		// ========== compress feature process ==========
-		if (yycc::cenum::has(this->m_FileInfo.FileWriteMode, CK_FILE_WRITEMODE::CKFILE_CHUNKCOMPRESSED_OLD)
-		    || yycc::cenum::has(this->m_FileInfo.FileWriteMode, CK_FILE_WRITEMODE::CKFILE_WHOLECOMPRESSED)) {
-
+		// The file with FileVersion >= 8 is decompressed progressively when reading manager and object data.
+		// Old files need the whole data to check CRC, so they are decompressed at once.
+		bool isCompressed = yycc::cenum::has(this->m_FileInfo.FileWriteMode, CK_FILE_WRITEMODE::CKFILE_CHUNKCOMPRESSED_OLD)
+			|| yycc::cenum::has(this->m_FileInfo.FileWriteMode, CK_FILE_WRITEMODE::CKFILE_WHOLECOMPRESSED);
+		bool isStreaming = isCompressed && this->m_FileInfo.FileVersion >= 8;
+		const void* packedData = parser->GetPtr();
+		if (isCompressed && !isStreaming) {
 			void* decomp_buffer = CKUnPackData(this->m_FileInfo.DataUnPackSize, parser->GetPtr(), this->m_FileInfo.DataPackSize);
 			if (decomp_buffer != nullptr) {
-				parser = std::unique_ptr<CKBufferParser>(new CKBufferParser(decomp_buffer, this->m_FileInfo.DataUnPackSize, true));
+				// decompressed buffer is kept by reader because loaded CKStateChunk will borrow data from it.
+				this->m_UnPackedData.reset(static_cast<CKBYTE*>(decomp_buffer));
+				parser = std::unique_ptr<CKBufferParser>(new CKBufferParser(decomp_buffer, this->m_FileInfo.DataUnPackSize, false));
 			}
 		}
+		if (isStreaming) {
+			// allocate buffer only. it will be filled when reading manager and object data.
+			this->m_UnPackedData.reset(new CKBYTE[this->m_FileInfo.DataUnPackSize]);
+			parser = std::unique_ptr<CKBufferParser>(new CKBufferParser(this->m_UnPackedData.get(), this->m_FileInfo.DataUnPackSize, false));
+		}
 
 		// ========== old file crc and obj list read ==========
 		// only file ver < 8 run this
 		if (this->m_FileInfo.FileVersion < 8) {
 			// check crc
-			CKDWORD gotten_crc = CKComputeDataCRC(
-				parser->GetPtr(),
-				parser->GetSize() - parser->GetCursor(),
-				0u
-			);
-			if (gotten_crc != this->m_FileInfo.Crc) {
-				this->m_Ctx->OutputToConsole(u8"Virtools file CRC error.");
-				return CKERROR::CKERR_FILECRCERROR;
-			}
+			// the data part is kept by reader, so it is safe to be checked in background.
+			CK_FILE_CRCVERIFYMODE crcMode = this->m_Ctx->GetFileCrcVerifyMode();
+			const void* dataPtr = parser->GetPtr();
+			CKDWORD dataSize = parser->GetSize() - parser->GetCursor();
+			CKDWORD expectedCrc = this->m_FileInfo.Crc;
+			CKDWORD workers = crcMode == CK_FILE_CRCVERIFYMODE::CKFILE_CRC_VERIFY ? this->m_Ctx->GetWorkerThreadCount() : 1u;
+			CKERROR err = this->VerifyFileCrc(crcMode, [dataPtr, dataSize, expectedCrc, workers]() -> bool {
+				return CKComputeDataCRC(dataPtr, dataSize, 0u, workers) == expectedCrc;
+			});
+			if (err != CKERROR::CKERR_OK) return err;
 
 			// MARK: why read again? especially for file ver == 7.
 			// get save id max
@@ -269,60 +514,170 @@ namespace LibCmo::CK2 {
 			}
 		}
 
-		// ========== manager read ==========
-		// only file ver >= 6 have this
+		// ========== manager and object read ==========
+		// Every CKStateChunk is prefixed by its size, and each of them is independent with others.
+		// So the first worker scans the buffer to collect the position of each CKStateChunk whose data is ready,
+		// and all workers (including the first one after scanning) convert collected CKStateChunk.
+		// For streaming file, the first worker scans data after each decompression window,
+		// so that CKStateChunk can be converted while decompressing.
+		// CKStateChunk borrow their data from file buffer directly, which is kept by reader.
+		struct PendingStateChunk {
+			CKStateChunk** m_Slot; /**< The pointer to the field receiving converted CKStateChunk. */
+			const void* m_Buffer; /**< The start address of CKStateChunk in buffer. */
+		};
+		XContainer::XArray<PendingStateChunk> pendingChunks;
+		size_t nextPendingChunk = 0u;
+		bool isScanFinished = false;
+		std::mutex pendingMutex;
+		std::condition_variable pendingCond;
+
+		// only file ver >= 6 have manager data
 		if (this->m_FileInfo.ManagerCount != 0) {
 			this->m_ManagersData.resize(this->m_FileInfo.ManagerCount);
-			CKDWORD stateChunkLen = 0u;
-			bool stateChkParseSuccess = false;
-
-			for (auto& mgr : this->m_ManagersData) {
-				// read guid
-				parser->Read(&mgr.Manager);
+		}
+		// only works file version >= 4. < 4 section has been removed.
+		size_t scanningManagerCount = this->m_ManagersData.size(), scannedManager = 0u;
+		size_t scanningObjectCount = this->m_FileInfo.ObjectCount != 0 ? this->m_FileObjects.size() : 0u, scannedObject = 0u;
 
-				// read statechunk len
-				parser->Read(&stateChunkLen);
-				// check len
-				if (stateChunkLen == 0) {
+		// scanner collecting CKStateChunk whose data is located before given position.
+		auto scanStateChunks = [&](CKDWORD available) -> void {
+			XContainer::XArray<PendingStateChunk> scanned;
+			CKDWORD stateChunkLen = 0u;
+			while (true) {
+				CKDWORD cursor = parser->GetCursor();
+				if (scannedManager < scanningManagerCount) {
+					auto& mgr = this->m_ManagersData[scannedManager];
+					// read guid and statechunk len
+					if (static_cast<CKQWORD>(cursor) + CKSizeof(CKGUID) + CKSizeof(CKDWORD) > available) break;
+					parser->Read(&mgr.Manager);
+					parser->Read(&stateChunkLen);
+					// wait more data if statechunk is not ready
+					if (static_cast<CKQWORD>(parser->GetCursor()) + stateChunkLen > available) {
+						parser->SetCursor(cursor);
+						break;
+					}
+
+					// record statechunk if it has
 					mgr.Data = nullptr;
-					continue;
+					if (stateChunkLen != 0) {
+						scanned.emplace_back(PendingStateChunk { &mgr.Data, parser->GetPtr() });
+						parser->MoveCursor(stateChunkLen);
+					}
+					++scannedManager;
+				} else if (scannedObject < scanningObjectCount) {
+					auto& obj = this->m_FileObjects[scannedObject];
+					// get statechunk len
+					if (static_cast<CKQWORD>(cursor) + CKSizeof(CKDWORD) > available) break;
+					parser->Read(&obj.PackSize);
+					// wait more data if statechunk is not ready
+					if (static_cast<CKQWORD>(parser->GetCursor()) + obj.PackSize > available) {
+						parser->SetCursor(cursor);
+						break;
+					}
+
+					// record state chunk if it has
+					obj.Data = nullptr;
+					if (obj.PackSize != 0) {
+						scanned.emplace_back(PendingStateChunk { &obj.Data, parser->GetPtr() });
+						parser->MoveCursor(obj.PackSize);
+					}
+					++scannedObject;
+				} else {
+					break;
 				}
+			}
 
-				// read statechunk
-				mgr.Data = new CKStateChunk(&this->m_Visitor, this->m_Ctx);
-				stateChkParseSuccess = mgr.Data->ConvertFromBuffer(parser->GetPtr());
-				if (!stateChkParseSuccess) {
-					delete mgr.Data;
-					mgr.Data = nullptr;
+			// publish scanned statechunks
+			if (!scanned.empty()) {
+				{
+					std::lock_guard<std::mutex> locker(pendingMutex);
+					pendingChunks.insert(pendingChunks.end(), scanned.begin(), scanned.end());
 				}
-				parser->MoveCursor(stateChunkLen);
+				pendingCond.notify_all();
 			}
-		}
-
-		// ========== object read ==========
-		// only works file version >= 4. < 4 section has been removed.
-		if (this->m_FileInfo.ObjectCount != 0) {
-			// new file reader section
-			bool stateChkParseSuccess = false;
-			for (auto& obj : this->m_FileObjects) {
-				// get statechunk len
-				parser->Read(&obj.PackSize);
-				// check state chunk len
-				if (obj.PackSize == 0) {
-					obj.Data = nullptr;
-					continue;
+		};
+		// notify all workers that no more statechunk will be collected.
+		auto finishScan = [&]() -> void {
+			{
+				std::lock_guard<std::mutex> locker(pendingMutex);
+				isScanFinished = true;
+			}
+			pendingCond.notify_all();
+		};
+		// converter converting collected statechunks until scanning finished.
+		auto convertStateChunks = [&]() -> void {
+			while (true) {
+				PendingStateChunk pending;
+				{
+					std::unique_lock<std::mutex> locker(pendingMutex);
+					pendingCond.wait(locker, [&]() -> bool {
+						return nextPendingChunk < pendingChunks.size() || isScanFinished;
+					});
+					if (nextPendingChunk >= pendingChunks.size()) return;
+					pending = pendingChunks[nextPendingChunk++];
 				}
 
-				// read state chunk
-				obj.Data = new CKStateChunk(&this->m_Visitor, this->m_Ctx);
-				stateChkParseSuccess = obj.Data->ConvertFromBuffer(parser->GetPtr());
-				if (!stateChkParseSuccess) {
-					delete obj.Data;
-					obj.Data = nullptr;
+				std::unique_ptr<CKStateChunk> chunk(new CKStateChunk(&this->m_Visitor, this->m_Ctx));
+				if (chunk->BorrowFromBuffer(pending.m_Buffer)) {
+					*pending.m_Slot = chunk.release();
 				}
-				parser->MoveCursor(obj.PackSize);
+			}
+		};
+
+		// run scanner and converters. return false if decompression failed.
+		auto readStateChunks = [&](bool streaming) -> bool {
+			// reset status
+			pendingChunks.clear();
+			pendingChunks.reserve(this->m_FileInfo.ManagerCount + this->m_FileInfo.ObjectCount);
+			nextPendingChunk = 0u;
+			isScanFinished = false;
+			scannedManager = scannedObject = 0u;
+
+			bool isUnPackSuccess = true;
+			CKDWORD workers = this->m_Ctx->GetWorkerThreadCount();
+			CKParallelFor(CKGetWorkerCount(workers), workers, [&](CKDWORD index) -> void {
+				// the first worker do scanning. 
+				// it is always executed because CKParallelFor dispatch index in order.
+				if (index == 0u) {
+					try {
+						if (streaming) {
+							isUnPackSuccess = CKUnPackDataProgressive(
+								this->m_UnPackedData.get(), this->m_FileInfo.DataUnPackSize,
+								packedData, this->m_FileInfo.DataPackSize,
+								c_UnPackWindowSize, scanStateChunks
+							);
+						} else {
+							scanStateChunks(parser->GetSize());
+						}
+					} catch (...) {
+						finishScan();
+						throw;
+					}
+					finishScan();
+				}
+
+				convertStateChunks();
+			});
 
+			return isUnPackSuccess;
+		};
+
+		if (!readStateChunks(isStreaming)) {
+			// fail to decompress. the data may be stored without compression even if compression flag is set,
+			// so read it again as raw data like what we do when CKUnPackData() failed.
+			for (auto& mgr : this->m_ManagersData) {
+				if (mgr.Data != nullptr) delete mgr.Data;
+				mgr.Data = nullptr;
 			}
+			for (auto& obj : this->m_FileObjects) {
+				if (obj.Data != nullptr) delete obj.Data;
+				obj.Data = nullptr;
+			}
+			this->m_UnPackedData.reset();
+
+			parser = std::unique_ptr<CKBufferParser>(new CKBufferParser(ParserPtr->GetBase(), ParserPtr->GetSize(), false));
+			parser->SetCursor(ParserPtr->GetCursor());
+			readStateChunks(false);
 		}
 
 		// ========== included file get ==========
@@ -375,23 +730,55 @@ namespace LibCmo::CK2 {
 		// check CKContext encoding sequence
 		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
 
-		// ========== prepare work ==========
-		CKERROR err = CKERROR::CKERR_OK;
+		// get shallow document first
+		CKERROR err = this->ShallowLoad(u8_filename);
+		if (err != CKERROR::CKERR_OK) return err;
+
+		return this->InternalDeepLoad();
+	}
+
+	CKERROR CKFileReader::DeepLoad(const void* buf, CKDWORD size) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
 
 		// get shallow document first
-		err = this->ShallowLoad(u8_filename);
+		CKERROR err = this->ShallowLoad(buf, size);
 		if (err != CKERROR::CKERR_OK) return err;
+
+		return this->InternalDeepLoad();
+	}
+
+	CKERROR CKFileReader::DeepLoad(CKFileSourceCallback source) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// get shallow document first
+		CKERROR err = this->ShallowLoad(source);
+		if (err != CKERROR::CKERR_OK) return err;
+
+		return this->InternalDeepLoad();
+	}
+
+	CKERROR CKFileReader::InternalDeepLoad() {
+		// ========== prepare work ==========
 		// reset done flag because we need further processing
 		this->m_Done = false;
+		this->m_PendingBitmaps.clear();
 
 		// ========== create object first ==========
 		for (auto& obj : this->m_FileObjects) {
 			// todo: skip CK_LEVEL
 			// todo: resolve references
 			if (obj.Data == nullptr) continue;
+			// skip filtered objects. their chunk is kept.
+			if (this->m_IsClassFiltered && !XContainer::NSXBitArray::IsSet(this->m_DeepLoadClassFilter, static_cast<CKDWORD>(obj.ObjectCid))) continue;
 
 			// create object and assign created obj ckid
-			obj.ObjPtr = m_Ctx->CreateObject(obj.ObjectCid, XContainer::NSXString::ToCKSTRING(obj.Name));
+			obj.ObjPtr = m_Ctx->CreateObject(obj.ObjectCid, obj.Name);
 			if (obj.ObjPtr == nullptr) {
 				obj.CreatedObjectId = 0u;
 			} else {
@@ -407,28 +794,55 @@ namespace LibCmo::CK2 {
 		// todo...
 
 		// ========== analyze objects CKStateChunk ==========
-		for (auto& obj : this->m_FileObjects) {
+		for (CKDWORD i = 0; i < this->m_FileObjects.size(); ++i) {
+			auto& obj = this->m_FileObjects[i];
 			if (obj.Data == nullptr || obj.ObjPtr == nullptr) continue;
 
 			// todo: special treat for CK_LEVEL
 			// try parsing data
+			this->m_LoadingObjectIndex = i;
 			obj.Data->StartRead();
 			bool success = obj.ObjPtr->Load(obj.Data, &this->m_Visitor);
 			obj.Data->StopRead();
 			if (success) {
-				// if success, clear CKStateChunk*
-				delete obj.Data;
-				obj.Data = nullptr;
+				// if success, clear CKStateChunk* unless it is requested to be kept
+				if (!this->m_KeepObjectChunks) {
+					delete obj.Data;
+					obj.Data = nullptr;
+				}
 			} else {
 				// if failed, delete it
-				m_Ctx->DestroyObject(obj.ObjectId);
+				m_Ctx->DestroyObject(obj.CreatedObjectId);
 				obj.ObjPtr = nullptr;
 				obj.CreatedObjectId = 0u;
 			}
 		}
 
-		// ========== finalize work ==========
+		// ========== decode images ==========
+		// if requested, images embedded in textures are decoded here in parallel,
+		// because decoding is slow and independent between bitmaps.
+		// otherwise m_PendingBitmaps is empty and they are decoded when accessing.
+		{
+			XContainer::XArray<CKBitmapData*> bitmaps;
+			for (const auto& [index, bmp] : this->m_PendingBitmaps) {
+				// skip the bitmap whose owner is destroyed
+				if (m_Ctx->GetObject(this->m_FileObjects[index].CreatedObjectId) == nullptr) continue;
+				bitmaps.emplace_back(bmp);
+			}
+			this->m_PendingBitmaps.clear();
 
+			CKParallelFor(static_cast<CKDWORD>(bitmaps.size()), m_Ctx->GetWorkerThreadCount(), [&](CKDWORD i) -> void {
+				bitmaps[i]->DecodePendingImages();
+			});
+		}
+
+		// ========== finalize work ==========
+		// loaded objects are identical to their CKStateChunk now.
+		// clear their modification flags after all objects are loaded,
+		// because loading object may modify other objects.
+		for (auto& obj : this->m_FileObjects) {
+			if (obj.ObjPtr != nullptr) obj.ObjPtr->SetDirty(false);
+		}
 
 		// set done flag and return
 		this->m_Done = true;
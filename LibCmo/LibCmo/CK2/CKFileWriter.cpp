@@ -8,22 +8,280 @@
 #include <yycc/cenum.hpp>
 #include <yycc/patch/fopen.hpp>
 #include <memory>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <atomic>
+#include <cstdio>
+#if defined(YYCC_OS_WINDOWS)
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace LibCmo::CK2 {
 
+	/**
+	 * @brief The size of data given to output in each step when writing uncompressed data part.
+	*/
+	static constexpr CKDWORD c_DataWindowSize = 1024u * 1024u;
+	/**
+	 * @brief The size of stdio buffer used when writing file.
+	 * @details Most of written data is given in large pieces, so a large buffer can merge small pieces like header fields.
+	*/
+	static constexpr size_t c_FileBufferSize = 4u * 1024u * 1024u;
+	/**
+	 * @brief The maximum count of names tried when creating temporary file.
+	*/
+	static constexpr CKDWORD c_TempFileAttempts = 64u;
+
+	/**
+	 * @brief Flush given file and make sure that its data is written into disk.
+	 * @param[in] fs The file to be flushed.
+	 * @return True if success.
+	*/
+	static bool InternalSyncFile(FILE* fs) {
+		if (std::fflush(fs) != 0) return false;
+#if defined(YYCC_OS_WINDOWS)
+		return _commit(_fileno(fs)) == 0;
+#else
+		return fsync(fileno(fs)) == 0;
+#endif
+	}
+
+	/**
+	 * @brief Create a temporary file located beside given file, and open it exclusively.
+	 * @param[in] u8_filename The destination file.
+	 * @param[out] tempFilename The name of created temporary file. Meaningless if failed.
+	 * @return The opened temporary file. nullptr if failed.
+	 * @remarks
+	 * The name of temporary file consists of process id and a process-wide counter,
+	 * and it is opened in exclusive mode, so it never reuses the file of other saving or user.
+	*/
+	static FILE* InternalCreateTempFile(CKSTRING u8_filename, XContainer::XString& tempFilename) {
+		static std::atomic<CKDWORD> s_TempFileCounter(0u);
+#if defined(YYCC_OS_WINDOWS)
+		unsigned long pid = static_cast<unsigned long>(_getpid());
+#else
+		unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+
+		char suffix[64];
+		for (CKDWORD i = 0; i < c_TempFileAttempts; ++i) {
+			unsigned long counter = static_cast<unsigned long>(s_TempFileCounter.fetch_add(1u));
+			std::snprintf(suffix, sizeof(suffix), ".%lu.%lu.tmp", pid, counter);
+			tempFilename = u8_filename;
+			tempFilename += reinterpret_cast<const char8_t*>(suffix);
+
+			// "x" makes opening fail if file exists.
+			FILE* fs = yycc::patch::fopen::fopen(tempFilename.c_str(), u8"wbx");
+			if (fs != nullptr) return fs;
+		}
+		return nullptr;
+	}
+
+	/**
+	 * @brief The file written by CKFileWriter::Save(CKSTRING).
+	 * @details
+	 * It closes the file and removes it when destructing unless it is committed,
+	 * so neither file handle nor broken file is left when saving is failed, including by exception.
+	*/
+	class SaveFileGuard {
+	public:
+		SaveFileGuard() : m_Fs(nullptr), m_Filename(), m_IsCommitted(false) {}
+		~SaveFileGuard() {
+			this->Close();
+			if (!this->m_Filename.empty() && !this->m_IsCommitted) {
+				std::error_code ec;
+				std::filesystem::remove(std::filesystem::path(this->m_Filename), ec);
+			}
+		}
+		YYCC_DELETE_COPY_MOVE(SaveFileGuard)
+
+		/**
+		 * @brief Take the ownership of opened file.
+		 * @param[in] fs The opened file.
+		 * @param[in] filename The name of opened file. It is removed if this guard is not committed.
+		*/
+		void Attach(FILE* fs, const XContainer::XString& filename) {
+			this->m_Fs = fs;
+			this->m_Filename = filename;
+		}
+		bool IsAttached() const { return !this->m_Filename.empty(); }
+		FILE* GetFile() const { return this->m_Fs; }
+		const XContainer::XString& GetFileName() const { return this->m_Filename; }
+		/**
+		 * @brief Close the file.
+		 * @return True if success or file has been closed.
+		 * @remarks Data kept in stdio buffer is written when closing, so its failure is a writing failure.
+		*/
+		bool Close() {
+			if (this->m_Fs == nullptr) return true;
+			bool ret = std::fclose(this->m_Fs) == 0;
+			this->m_Fs = nullptr;
+			return ret;
+		}
+		/**
+		 * @brief Keep the file after destructing this guard.
+		*/
+		void Commit() { this->m_IsCommitted = true; }
+
+	private:
+		FILE* m_Fs;
+		XContainer::XString m_Filename;
+		bool m_IsCommitted;
+	};
+
 	CKERROR CKFileWriter::Save(CKSTRING u8_filename) {
 		// check document status
 		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
 		// check CKContext encoding sequence
 		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
 
-		// encoding conv helper
-		std::string name_conv;
+		// decide the file we actually write.
+		// in atomic mode, we write a temporary file and rename it to destination finally.
+		// so no need to check destination file because it is never touched before renaming.
+		CKERROR err;
+		bool isAtomic = this->m_IsAtomicSave;
+		if (isAtomic) {
+			if (u8_filename == nullptr) return CKERROR::CKERR_INVALIDFILE;
+		} else {
+			// try detect filename legality
+			err = PrepareFile(u8_filename);
+			if (err != CKERROR::CKERR_OK) return err;
+		}
+
+		// file is opened when writing first data,
+		// so that it will not be touched if we fail before writing.
+		// in atomic mode, the opened file is an unique temporary file.
+		// the guard removes opened file if we fail, because destination has been truncated
+		// and partially written in non-atomic mode, and temporary file is useless in atomic mode.
+		SaveFileGuard file;
+		CKFileSinkCallback sink([&file, isAtomic, u8_filename](const void* data, CKDWORD size) -> bool {
+			if (!file.IsAttached()) {
+				XContainer::XString filename;
+				FILE* fs = nullptr;
+				if (isAtomic) {
+					fs = InternalCreateTempFile(u8_filename, filename);
+				} else {
+					filename = u8_filename;
+					fs = yycc::patch::fopen::fopen(u8_filename, u8"wb");
+				}
+				if (fs == nullptr) return false;
+				file.Attach(fs, filename);
+				// use large buffer to reduce the count of system calls
+				std::setvbuf(fs, nullptr, _IOFBF, c_FileBufferSize);
+			}
+			return std::fwrite(data, sizeof(CKBYTE), size, file.GetFile()) == size;
+		});
+		CKFilePatchCallback patcher([&file](CKDWORD offset, const void* data, CKDWORD size) -> bool {
+			FILE* fs = file.GetFile();
+			if (fs == nullptr) return false;
+			if (std::fseek(fs, static_cast<long>(offset), SEEK_SET) != 0) return false;
+			bool ret = std::fwrite(data, sizeof(CKBYTE), size, fs) == size;
+			// go back to the end for following writing
+			if (std::fseek(fs, 0, SEEK_END) != 0) return false;
+			return ret;
+		});
+		err = this->InternalSave(sink, patcher);
+
+		// close file
+		if (!isAtomic) {
+			if (file.IsAttached()) {
+				if (!file.Close() && err == CKERROR::CKERR_OK) err = CKERROR::CKERR_CANTWRITETOFILE;
+				if (err == CKERROR::CKERR_OK) file.Commit();
+			}
+			return err;
+		}
 
-		// try detect filename legality
-		CKERROR err = PrepareFile(u8_filename);
+		// for atomic mode, flush temporary file into disk before replacing destination,
+		// otherwise destination may be replaced by an incomplete file when system crashed.
+		if (file.IsAttached()) {
+			if (err == CKERROR::CKERR_OK && !InternalSyncFile(file.GetFile())) err = CKERROR::CKERR_CANTWRITETOFILE;
+			if (!file.Close() && err == CKERROR::CKERR_OK) err = CKERROR::CKERR_CANTWRITETOFILE;
+		} else if (err == CKERROR::CKERR_OK) {
+			err = CKERROR::CKERR_CANTWRITETOFILE;
+		}
+		if (err != CKERROR::CKERR_OK) return err;
+
+		// temporary file is created with default permissions.
+		// copy the permissions of existing destination, otherwise renaming will change them.
+		// it is not a failure if permissions can not be copied, e.g. filesystem do not support them.
+		std::filesystem::path tempPath(file.GetFileName()), destPath(u8_filename);
+		std::error_code ec;
+		std::filesystem::file_status destStatus = std::filesystem::status(destPath, ec);
+		if (!ec && std::filesystem::exists(destStatus)) {
+			std::filesystem::permissions(tempPath, destStatus.permissions(), std::filesystem::perm_options::replace, ec);
+		}
+
+		// replace destination with temporary file.
+		// temporary file is removed by guard if failed.
+		std::filesystem::rename(tempPath, destPath, ec);
+		if (ec) return CKERROR::CKERR_CANTWRITETOFILE;
+		file.Commit();
+		return CKERROR::CKERR_OK;
+	}
+
+	CKERROR CKFileWriter::Save(CKFileSinkCallback sink) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check sink
+		if (sink == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		// sink can not be overwritten, so buffer the whole file first.
+		XContainer::XArray<CKBYTE> buffer;
+		CKERROR err = this->Save(buffer);
 		if (err != CKERROR::CKERR_OK) return err;
 
+		// pass buffer to sink piece by piece
+		for (size_t pos = 0u; pos < buffer.size(); pos += c_DataWindowSize) {
+			CKDWORD size = static_cast<CKDWORD>(std::min(static_cast<size_t>(c_DataWindowSize), buffer.size() - pos));
+			if (!sink(buffer.data() + pos, size)) return CKERROR::CKERR_CANTWRITETOFILE;
+		}
+		return CKERROR::CKERR_OK;
+	}
+
+	CKERROR CKFileWriter::Save(CKFileSinkCallback sink, CKFilePatchCallback patcher) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// check callbacks
+		if (sink == nullptr || patcher == nullptr) return CKERROR::CKERR_INVALIDPARAMETER;
+
+		return this->InternalSave(sink, patcher);
+	}
+
+	CKERROR CKFileWriter::Save(XContainer::XArray<CKBYTE>& buffer) {
+		// check document status
+		if (this->m_Done) return CKERROR::CKERR_CANCELLED;
+		// check CKContext encoding sequence
+		if (!this->m_Ctx->IsValidEncoding()) return CKERROR::CKERR_CANCELLED;
+
+		// append all data into buffer
+		buffer.clear();
+		CKFileSinkCallback sink([&buffer](const void* data, CKDWORD size) -> bool {
+			const CKBYTE* bytes = static_cast<const CKBYTE*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+			return true;
+		});
+		CKFilePatchCallback patcher([&buffer](CKDWORD offset, const void* data, CKDWORD size) -> bool {
+			if (static_cast<size_t>(offset) + size > buffer.size()) return false;
+			std::memcpy(buffer.data() + offset, data, size);
+			return true;
+		});
+		return this->InternalSave(sink, patcher);
+	}
+
+	CKERROR CKFileWriter::InternalSave(CKFileSinkCallback& sink, CKFilePatchCallback& patcher) {
+		// encoding conv helper
+		std::string name_conv;
+
 		// ========== Prepare Stage ==========
 		// todo: add TOBEDELETED flag for all Referenced objects's m_ObjectFlags
 
@@ -34,18 +292,40 @@ namespace LibCmo::CK2 {
 		// iterate all objects and transform it into CKStateChunk
 		// MARK: Drop the support of collecting the sum of InterfaceChunk's size.
 		// because it is useless.
-		for (auto& obj : m_FileObjects) {
-			// if there is a chunk, skip
-			if (obj.Data != nullptr) continue;
-
-			obj.Data = new CKStateChunk(&m_Visitor, m_Ctx);
-			obj.Data->StartWrite();
-			bool suc = obj.ObjPtr->Save(obj.Data, &m_Visitor, obj.SaveFlags);
-			obj.Data->StopWrite();
-			if (!suc) {
-				// fail to parse
-				delete obj.Data;
-				obj.Data = nullptr;
+		{
+			// collect objects which need to be serialized.
+			// the object which already has a chunk will be skipped.
+			XContainer::XArray<CKDWORD> pendingObjects;
+			for (CKDWORD i = 0; i < static_cast<CKDWORD>(m_FileObjects.size()); ++i) {
+				if (m_FileObjects[i].Data == nullptr) pendingObjects.emplace_back(i);
+			}
+
+			// serialize objects in workers.
+			// each object only touch its own chunk, and the files it added are deferred
+			// to make sure that the order of included files is the same with serial saving.
+			XContainer::XArray<XContainer::XArray<XContainer::XString>> deferredFiles(pendingObjects.size());
+			CKParallelFor(static_cast<CKDWORD>(pendingObjects.size()), m_Ctx->GetWorkerThreadCount(), [&](CKDWORD i) -> void {
+				CKFileObject& obj = m_FileObjects[pendingObjects[i]];
+				CKFileVisitor visitor(this, &deferredFiles[i]);
+
+				CKStateChunk* chunk = new CKStateChunk(&m_Visitor, m_Ctx);
+				chunk->SetBufferPool(m_ChunkBufferPool.get());
+				chunk->StartWrite();
+				bool suc = obj.ObjPtr->Save(chunk, &visitor, obj.SaveFlags);
+				chunk->StopWrite();
+				if (suc) {
+					obj.Data = chunk;
+				} else {
+					// fail to parse
+					delete chunk;
+				}
+			});
+
+			// add deferred files in object order
+			for (const auto& files : deferredFiles) {
+				for (const auto& file : files) {
+					this->AddSavedFile(file.c_str());
+				}
 			}
 		}
 
@@ -64,6 +344,7 @@ namespace LibCmo::CK2 {
 				m_ManagersData[availablemgr].Manager = mgr->GetGuid();
 
 				m_ManagersData[availablemgr].Data = new CKStateChunk(&m_Visitor, m_Ctx);
+				m_ManagersData[availablemgr].Data->SetBufferPool(m_ChunkBufferPool.get());
 				m_ManagersData[availablemgr].Data->StartWrite();
 				bool suc = mgr->SaveData(m_ManagersData[availablemgr].Data, &m_Visitor);
 				m_ManagersData[availablemgr].Data->StopWrite();
@@ -91,9 +372,9 @@ namespace LibCmo::CK2 {
 		for (auto& obj : m_FileObjects) {
 			// += 4DWORD(ObjId, ObjCid, FileIndex, NameLen)
 			sumHdrObjSize += 4 * CKSizeof(CKDWORD);
-			if (XContainer::NSXString::ToCKSTRING(obj.Name) != nullptr) {
+			if (obj.Name != nullptr) {
 				// += Name size
-				if (!m_Ctx->GetOrdinaryString(obj.Name, name_conv))
+				if (!m_Ctx->GetOrdinaryName(obj.Name, name_conv))
 					m_Ctx->OutputToConsole(u8"Fail to get ordinary string for CKObject name when computing the size of saved file. It may cause application crash or saved file has blank object name.");
 				sumHdrObjSize += static_cast<CKDWORD>(name_conv.size());
 			}
@@ -179,9 +460,9 @@ namespace LibCmo::CK2 {
 			hdrparser->Write(&obj.ObjectCid);
 			hdrparser->Write(&obj.FileIndex);
 
-			if (XContainer::NSXString::ToCKSTRING(obj.Name) != nullptr) {
+			if (obj.Name != nullptr) {
 				// if have name, write it
-				if (!m_Ctx->GetOrdinaryString(obj.Name, name_conv))
+				if (!m_Ctx->GetOrdinaryName(obj.Name, name_conv))
 					m_Ctx->OutputToConsole(u8"Fail to get ordinary string for CKObject name when saving file. Some objects may be saved with blank name.");
 				CKDWORD namelen = static_cast<CKDWORD>(name_conv.size());
 				hdrparser->Write(&namelen);
@@ -222,7 +503,7 @@ namespace LibCmo::CK2 {
 		    || yycc::cenum::has(fileWriteMode, CK_FILE_WRITEMODE::CKFILE_WHOLECOMPRESSED)) {
 
 			CKDWORD comp_buf_size = 0;
-			void* comp_buffer = CKPackData(hdrparser->GetBase(), hdrparser->GetSize(), comp_buf_size, m_Ctx->GetCompressionLevel());
+			void* comp_buffer = CKPackData(hdrparser->GetBase(), hdrparser->GetSize(), comp_buf_size, m_Ctx->GetCompressionLevel(), m_Ctx->GetWorkerThreadCount());
 			if (comp_buffer != nullptr) {
 				hdrparser = std::unique_ptr<CKBufferParser>(new CKBufferParser(comp_buffer, comp_buf_size, true));
 				rawHeader.Hdr1PackSize = comp_buf_size;
@@ -232,58 +513,98 @@ namespace LibCmo::CK2 {
 			}
 		}
 
-		// ========== Write data ==========
-		// create a buffer
-		std::unique_ptr<CKBufferParser> datparser(new CKBufferParser(sumDataSize));
+		// ========== Write Small Header and Header ==========
+		// write small header + header first.
+		// the size of data part and crc are unknown until data part is written,
+		// so small header will be overwritten by patcher later.
+		if (!sink(&rawHeader, CKSizeof(CKRawFileInfo))) return CKERROR::CKERR_CANTWRITETOFILE;
+		if (!sink(hdrparser->GetBase(), hdrparser->GetSize())) return CKERROR::CKERR_CANTWRITETOFILE;
 
-		// write manager
-		for (auto& mgr : m_ManagersData) {
-			datparser->Write(&mgr.Manager);
-
-			CKDWORD writtenSize = 0;
-			if (mgr.Data != nullptr) {
-				writtenSize = mgr.Data->ConvertToBuffer(datparser->GetMutablePtr(CKSizeof(CKDWORD)));
-				delete mgr.Data;
-				mgr.Data = nullptr;
+		// ========== Write data ==========
+		// data part is not built in memory as a whole.
+		// each manager and object is converted into a scratch buffer in order,
+		// then the scratch buffer is given to output (or compressor) piece by piece.
+		XContainer::XArray<CKBYTE> scratch;
+		size_t scratchPos = 0u;
+		size_t itemIndex = 0u;
+		const size_t mgrCount = m_ManagersData.size(), itemCount = m_ManagersData.size() + m_FileObjects.size();
+		CKQWORD generatedSize = 0u;
+		auto nextItem = [&]() -> void {
+			scratchPos = 0u;
+			if (itemIndex < mgrCount) {
+				// manager: guid + chunk size + chunk
+				auto& mgr = m_ManagersData[itemIndex];
+				CKDWORD writtenSize = mgr.Data == nullptr ? 0u : mgr.Data->ConvertToBuffer(nullptr);
+				scratch.resize(sizeof(CKGUID) + sizeof(CKDWORD) + writtenSize);
+				std::memcpy(scratch.data(), &mgr.Manager, sizeof(CKGUID));
+				std::memcpy(scratch.data() + sizeof(CKGUID), &writtenSize, sizeof(CKDWORD));
+				if (mgr.Data != nullptr) {
+					mgr.Data->ConvertToBuffer(scratch.data() + sizeof(CKGUID) + sizeof(CKDWORD));
+					delete mgr.Data;
+					mgr.Data = nullptr;
+				}
+			} else {
+				// object: chunk size + chunk
+				auto& obj = m_FileObjects[itemIndex - mgrCount];
+				scratch.resize(sizeof(CKDWORD) + obj.PackSize);
+				std::memcpy(scratch.data(), &obj.PackSize, sizeof(CKDWORD));
+				if (obj.Data != nullptr) {
+					obj.Data->ConvertToBuffer(scratch.data() + sizeof(CKDWORD));
+					delete obj.Data;
+					obj.Data = nullptr;
+				}
 			}
-
-			datparser->Write(&writtenSize);
-			datparser->MoveCursor(writtenSize);
-		}
-
-		// write object
-		for (auto& obj : m_FileObjects) {
-			datparser->Write(&obj.PackSize);
-
-			if (obj.Data != nullptr) {
-				obj.Data->ConvertToBuffer(datparser->GetMutablePtr());
-				delete obj.Data;
-				obj.Data = nullptr;
+			++itemIndex;
+		};
+		CKPackSourceFct dataSource([&](void* buf, CKDWORD size) -> CKDWORD {
+			CKDWORD written = 0u;
+			while (written < size) {
+				if (scratchPos >= scratch.size()) {
+					if (itemIndex >= itemCount) break;
+					nextItem();
+					continue;
+				}
+				CKDWORD count = static_cast<CKDWORD>(std::min(static_cast<size_t>(size - written), scratch.size() - scratchPos));
+				std::memcpy(static_cast<CKBYTE*>(buf) + written, scratch.data() + scratchPos, count);
+				scratchPos += count;
+				written += count;
 			}
-
-			datparser->MoveCursor(obj.PackSize);
-		}
-
-		// compress header if needed
+			generatedSize += written;
+			return written;
+		});
+
+		// output data part and compute its standalone crc at the same time.
+		CKDWORD dataCrc = 1u;
+		CKFileSinkCallback dataSink([&sink, &dataCrc](const void* data, CKDWORD size) -> bool {
+			dataCrc = CKComputeDataCRC(data, size, dataCrc);
+			return sink(data, size);
+		});
 		if (yycc::cenum::has(fileWriteMode, CK_FILE_WRITEMODE::CKFILE_CHUNKCOMPRESSED_OLD)
 		    || yycc::cenum::has(fileWriteMode, CK_FILE_WRITEMODE::CKFILE_WHOLECOMPRESSED)) {
-
-			CKDWORD comp_buf_size = 0;
-			void* comp_buffer = CKPackData(datparser->GetBase(), datparser->GetSize(), comp_buf_size, m_Ctx->GetCompressionLevel());
-			if (comp_buffer != nullptr) {
-				datparser = std::unique_ptr<CKBufferParser>(new CKBufferParser(comp_buffer, comp_buf_size, true));
-				rawHeader.DataPackSize = comp_buf_size;
-			} else {
-				// fallback
-				rawHeader.DataPackSize = rawHeader.DataUnPackSize;
+			CKDWORD comp_size = 0u;
+			if (!CKPackDataStreaming(dataSource, dataSink, comp_size, m_Ctx->GetCompressionLevel(), m_Ctx->GetWorkerThreadCount()))
+				return CKERROR::CKERR_CANTWRITETOFILE;
+			rawHeader.DataPackSize = comp_size;
+		} else {
+			XContainer::XArray<CKBYTE> window(c_DataWindowSize);
+			while (true) {
+				CKDWORD got = dataSource(window.data(), c_DataWindowSize);
+				if (got != 0u && !dataSink(window.data(), got)) return CKERROR::CKERR_CANTWRITETOFILE;
+				if (got < c_DataWindowSize) break;
 			}
 		}
+		scratch.clear();
+		scratch.shrink_to_fit();
+		// check the size of generated data part with computed size.
+		if (generatedSize != static_cast<CKQWORD>(rawHeader.DataUnPackSize))
+			throw LogicException("The size of generated data part is different with computed size.");
 
 		// ========== Construct File Info ==========
 		// compute crc
+		// data part has been written, so chain its standalone crc after header crc.
 		CKDWORD computedcrc = CKComputeDataCRC(&rawHeader, CKSizeof(CKRawFileInfo), 0u);
 		computedcrc = CKComputeDataCRC(hdrparser->GetBase(), hdrparser->GetSize(), computedcrc);
-		computedcrc = CKComputeDataCRC(datparser->GetBase(), datparser->GetSize(), computedcrc);
+		computedcrc = CKCombineDataCRC(computedcrc, dataCrc, rawHeader.DataPackSize);
 
 		// copy to file info
 		this->m_FileInfo.ProductVersion = rawHeader.ProductVersion;
@@ -303,17 +624,11 @@ namespace LibCmo::CK2 {
 		this->m_FileInfo.Crc = computedcrc;
 		rawHeader.Crc = computedcrc;
 
-		// ========== Open File & Write Essential Data ==========
-		// open file and test
-		FILE* fs = yycc::patch::fopen::fopen(u8_filename, u8"wb");
-		if (fs == nullptr) return CKERROR::CKERR_CANTWRITETOFILE;
-		// write small header + header + data
-		std::fwrite(&rawHeader, sizeof(CKRawFileInfo), 1, fs);
-		std::fwrite(hdrparser->GetBase(), sizeof(CKBYTE), hdrparser->GetSize(), fs);
-		std::fwrite(datparser->GetBase(), sizeof(CKBYTE), datparser->GetSize(), fs);
+		// ========== Patch Header ==========
+		// overwrite small header with final data part size and crc
+		if (!patcher(0u, &rawHeader, CKSizeof(CKRawFileInfo))) return CKERROR::CKERR_CANTWRITETOFILE;
 		// free buffer
 		hdrparser.reset();
-		datparser.reset();
 
 		// ========== Included Files ==========
 		for (const auto& fentry : m_IncludedFiles) {
@@ -325,22 +640,22 @@ namespace LibCmo::CK2 {
 			if (!m_Ctx->GetOrdinaryString(filename, name_conv))
 				m_Ctx->OutputToConsole(u8"Fail to get ordinary string for included file when saving file. Some included files may not be saved correctly.");
 			CKDWORD filenamelen = static_cast<CKDWORD>(name_conv.size());
-			std::fwrite(&filenamelen, sizeof(CKDWORD), 1, fs);
-			std::fwrite(name_conv.data(), sizeof(CKBYTE), filenamelen, fs);
+			if (!sink(&filenamelen, CKSizeof(CKDWORD))) return CKERROR::CKERR_CANTWRITETOFILE;
+			if (!sink(name_conv.data(), filenamelen)) return CKERROR::CKERR_CANTWRITETOFILE;
 
 			// try mapping file.
 			std::unique_ptr<VxMath::VxMemoryMappedFile> mappedFile(new VxMath::VxMemoryMappedFile(fentry.c_str()));
 			if (mappedFile->IsValid()) {
 				// write file length
 				CKDWORD filebodylen = mappedFile->GetFileSize();
-				std::fwrite(&filebodylen, sizeof(CKDWORD), 1, fs);
+				if (!sink(&filebodylen, CKSizeof(CKDWORD))) return CKERROR::CKERR_CANTWRITETOFILE;
 
 				// write file body
-				std::fwrite(mappedFile->GetBase(), sizeof(CKBYTE), filebodylen, fs);
+				if (!sink(mappedFile->GetBase(), filebodylen)) return CKERROR::CKERR_CANTWRITETOFILE;
 			} else {
 				// write zero file length
 				CKDWORD filebodylen = 0;
-				std::fwrite(&filebodylen, sizeof(CKDWORD), 1, fs);
+				if (!sink(&filebodylen, CKSizeof(CKDWORD))) return CKERROR::CKERR_CANTWRITETOFILE;
 
 				// report error
 				m_Ctx->OutputToConsoleEx(u8"Fail to open temp file: %" PRI_CKSTRING, fentry.c_str());
@@ -351,9 +666,6 @@ namespace LibCmo::CK2 {
 
 		}
 
-		// close file
-		std::fclose(fs);
-
 		// set done flag and return
 		this->m_Done = true;
 		return CKERROR::CKERR_OK;
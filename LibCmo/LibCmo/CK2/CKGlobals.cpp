@@ -4,6 +4,11 @@
 // We import zlib first to prevent any possible conflict.
 #include <zconf.h>
 #include <zlib.h>
+// zlib only declares adler32_combine64() when large file support is enabled (never on Windows),
+// but it is always exported and takes z_off64_t. Declare it for these platforms.
+extern "C" {
+	ZEXTERN uLong ZEXPORT adler32_combine64(uLong, uLong, z_off64_t);
+}
 
 // Import self header
 #include "CKGlobals.hpp"
@@ -14,8 +19,15 @@
 #include <limits>
 #include <cctype>
 #include <cstring>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <new>
 
 // Import implementations.
+#include "CKContext.hpp"
+#include "MgrImpls/CKObjectManager.hpp"
 #include "ObjImpls/CKObject.hpp"
 #include "ObjImpls/CKSceneObject.hpp"
 #include "ObjImpls/CKBeObject.hpp"
@@ -35,11 +47,165 @@ namespace LibCmo::CK2 {
 
 #pragma region Compression Utilities
 
-	void* CKPackData(const void* Data, CKDWORD size, CKDWORD& NewSize, CKINT compressionlevel) {
+	/**
+	 * @brief The size of each block when compressing data in parallel.
+	*/
+	static constexpr CKDWORD c_PackBlockSize = 256u * 1024u;
+	/**
+	 * @brief The size of dictionary taken from previous block when compressing data in parallel.
+	 * @details It is the maximum window size of deflate.
+	*/
+	static constexpr CKDWORD c_PackDictSize = 32u * 1024u;
+	/**
+	 * @brief The size of each block when computing CRC in parallel.
+	*/
+	static constexpr CKDWORD c_CRCBlockSize = 4u * 1024u * 1024u;
+
+	/**
+	 * @brief Deflate a block into raw deflate data.
+	 * @param[in] dict The data used as preset dictionary. nullptr if no dictionary.
+	 * @param[in] dictsize The size of dictionary.
+	 * @param[in] src The data of this block.
+	 * @param[in] srcsize The size of this block.
+	 * @param[in] is_last True if this block is the last block of whole stream.
+	 * @param[in] compressionlevel The compression level.
+	 * @param[out] dst The buffer receiving deflated data.
+	 * @return True if success.
+	 * @remarks
+	 * The last block is finished with final deflate block.
+	 * Other blocks are ended with sync flush, so they are aligned to byte boundary
+	 * and the next block can be appended directly.
+	*/
+	static bool InternalPackBlock(const CKBYTE* dict, CKDWORD dictsize, const CKBYTE* src, CKDWORD srcsize,
+		bool is_last, CKINT compressionlevel, XContainer::XArray<CKBYTE>& dst) {
+		z_stream strm;
+		std::memset(&strm, 0, sizeof(z_stream));
+		// use negative window bits to produce raw deflate data without zlib header and trailer.
+		if (deflateInit2(&strm, static_cast<int>(compressionlevel), Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			return false;
+		if (dictsize != 0u && deflateSetDictionary(&strm, dict, static_cast<uInt>(dictsize)) != Z_OK) {
+			deflateEnd(&strm);
+			return false;
+		}
+
+		// prepare buffer. add some extra space for flush marker.
+		dst.resize(static_cast<size_t>(deflateBound(&strm, static_cast<uLong>(srcsize))) + 16u);
+		strm.next_in = const_cast<Bytef*>(src);
+		strm.avail_in = static_cast<uInt>(srcsize);
+
+		int flush = is_last ? Z_FINISH : Z_SYNC_FLUSH;
+		bool ok = false;
+		while (true) {
+			strm.next_out = reinterpret_cast<Bytef*>(dst.data() + strm.total_out);
+			strm.avail_out = static_cast<uInt>(dst.size() - strm.total_out);
+			int ret = deflate(&strm, flush);
+			if (ret == Z_STREAM_ERROR) break;
+			// check whether finished.
+			// for sync flush, it is finished if there is remained output space after consuming all input.
+			if (is_last ? (ret == Z_STREAM_END) : (strm.avail_in == 0u && strm.avail_out != 0u)) {
+				ok = true;
+				break;
+			}
+			// otherwise enlarge buffer and try again
+			dst.resize(dst.size() * 2u);
+		}
+
+		dst.resize(static_cast<size_t>(strm.total_out));
+		deflateEnd(&strm);
+		return ok;
+	}
+
+	/**
+	 * @brief Compress data in parallel and produce a standard zlib stream.
+	 * @param[in] Data The data to compress.
+	 * @param[in] size The size of data. It must be greater than c_PackBlockSize.
+	 * @param[out] NewSize The size of compressed data. 0 if failed.
+	 * @param[in] compressionlevel The compression level.
+	 * @param[in] workers The count of workers.
+	 * @return The compressed data or nullptr if failed.
+	*/
+	static void* InternalParallelPackData(const CKBYTE* Data, CKDWORD size, CKDWORD& NewSize, CKINT compressionlevel, CKDWORD workers) {
+		// split blocks
+		CKDWORD blockcount = (size + c_PackBlockSize - 1u) / c_PackBlockSize;
+		XContainer::XArray<XContainer::XArray<CKBYTE>> blocks(blockcount);
+		XContainer::XArray<CKDWORD> blockadlers(blockcount);
+		std::atomic_bool failed(false);
+
+		// deflate and compute adler32 for each block in workers
+		CKParallelFor(blockcount, workers, [&](CKDWORD i) -> void {
+			CKDWORD blockpos = i * c_PackBlockSize;
+			CKDWORD blocksize = std::min(c_PackBlockSize, size - blockpos);
+			CKDWORD dictsize = std::min(c_PackDictSize, blockpos);
+
+			if (!InternalPackBlock(Data + blockpos - dictsize, dictsize, Data + blockpos, blocksize,
+				i + 1u == blockcount, compressionlevel, blocks[i])) {
+				failed.store(true);
+			}
+			blockadlers[i] = static_cast<CKDWORD>(adler32(
+				adler32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(Data + blockpos), static_cast<uInt>(blocksize)));
+		});
+		if (failed.load()) {
+			NewSize = 0u;
+			return nullptr;
+		}
+
+		// combine adler32 of all blocks
+		uLong adler = static_cast<uLong>(blockadlers[0]);
+		for (CKDWORD i = 1; i < blockcount; ++i) {
+			CKDWORD blocksize = std::min(c_PackBlockSize, size - i * c_PackBlockSize);
+			adler = adler32_combine(adler, static_cast<uLong>(blockadlers[i]), static_cast<z_off_t>(blocksize));
+		}
+
+		// compute the total size.
+		// zlib header is 2 bytes and trailer (adler32) is 4 bytes.
+		size_t totalsize = 2u + 4u;
+		for (const auto& block : blocks) {
+			totalsize += block.size();
+		}
+		if (totalsize > static_cast<size_t>(std::numeric_limits<CKDWORD>::max())) {
+			NewSize = 0u;
+			return nullptr;
+		}
+		std::unique_ptr<CKBYTE[]> DestBuffer(new CKBYTE[totalsize]);
+		CKBYTE* cursor = DestBuffer.get();
+
+		// write zlib header.
+		// CMF: deflate method with 32K window.
+		// FLG: compression level hint computed like zlib does, and FCHECK making header be multiple of 31.
+		CKINT level = compressionlevel == Z_DEFAULT_COMPRESSION ? 6 : compressionlevel;
+		CKBYTE flevel = level < 2 ? 0u : (level < 6 ? 1u : (level == 6 ? 2u : 3u));
+		CKBYTE cmf = 0x78u;
+		CKBYTE flg = static_cast<CKBYTE>(flevel << 6);
+		flg = static_cast<CKBYTE>(flg + (31u - ((static_cast<CKDWORD>(cmf) * 256u + flg) % 31u)));
+		*(cursor++) = cmf;
+		*(cursor++) = flg;
+
+		// write blocks
+		for (const auto& block : blocks) {
+			if (!block.empty()) std::memcpy(cursor, block.data(), block.size());
+			cursor += block.size();
+		}
+
+		// write adler32 in big endian
+		*(cursor++) = static_cast<CKBYTE>((adler >> 24) & 0xFFu);
+		*(cursor++) = static_cast<CKBYTE>((adler >> 16) & 0xFFu);
+		*(cursor++) = static_cast<CKBYTE>((adler >> 8) & 0xFFu);
+		*(cursor++) = static_cast<CKBYTE>(adler & 0xFFu);
+
+		NewSize = static_cast<CKDWORD>(totalsize);
+		return DestBuffer.release();
+	}
+
+	void* CKPackData(const void* Data, CKDWORD size, CKDWORD& NewSize, CKINT compressionlevel, CKDWORD workers) {
 		// check argument
 		if (Data == nullptr && size != 0u)
 			throw LogicException("Data passed in CKPackData should not be nullptr.");
 
+		// use parallel compression if we have multiple workers and data is large enough.
+		if (CKGetWorkerCount(workers) > 1u && size > c_PackBlockSize) {
+			return InternalParallelPackData(static_cast<const CKBYTE*>(Data), size, NewSize, compressionlevel, workers);
+		}
+
 		// get boundary and allocate buffer.
 		uLong boundary = compressBound(static_cast<uLong>(size));
 		std::unique_ptr<CKBYTE[]> DestBuffer(new CKBYTE[boundary]);
@@ -59,6 +225,90 @@ namespace LibCmo::CK2 {
 		return DestBuffer.release();
 	}
 
+	bool CKPackDataStreaming(CKPackSourceFct Source, CKPackSinkFct Sink, CKDWORD& NewSize, CKINT compressionlevel, CKDWORD workers) {
+		// check argument
+		if (Source == nullptr || Sink == nullptr)
+			throw LogicException("Callbacks passed in CKPackDataStreaming should not be nullptr.");
+		NewSize = 0u;
+
+		// each batch contains one block for each worker.
+		// the window holds the dictionary taken from previous batch, followed by current batch.
+		workers = CKGetWorkerCount(workers);
+		CKDWORD batchsize = workers * c_PackBlockSize;
+		XContainer::XArray<CKBYTE> window(static_cast<size_t>(c_PackDictSize) + batchsize);
+		CKDWORD dictsize = 0u;
+		XContainer::XArray<XContainer::XArray<CKBYTE>> blocks(workers);
+		uLong adler = adler32(0L, Z_NULL, 0);
+		CKQWORD totalsize = 0u;
+		auto output = [&Sink, &totalsize](const void* data, CKDWORD size) -> bool {
+			totalsize += size;
+			if (totalsize > static_cast<CKQWORD>(std::numeric_limits<CKDWORD>::max())) return false;
+			return Sink(data, size);
+		};
+
+		// write zlib header. same as InternalParallelPackData().
+		CKINT level = compressionlevel == Z_DEFAULT_COMPRESSION ? 6 : compressionlevel;
+		CKBYTE flevel = level < 2 ? 0u : (level < 6 ? 1u : (level == 6 ? 2u : 3u));
+		CKBYTE zheader[2] { 0x78u, static_cast<CKBYTE>(flevel << 6) };
+		zheader[1] = static_cast<CKBYTE>(zheader[1] + (31u - ((static_cast<CKDWORD>(zheader[0]) * 256u + zheader[1]) % 31u)));
+		if (!output(zheader, CKSizeof(zheader))) return false;
+
+		while (true) {
+			// fill batch
+			CKBYTE* batch = window.data() + dictsize;
+			CKDWORD filled = 0u;
+			while (filled < batchsize) {
+				CKDWORD got = Source(batch + filled, batchsize - filled);
+				filled += got;
+				if (got == 0u) break;
+			}
+			bool is_eof = filled < batchsize;
+
+			// split batch into blocks.
+			// if it is the end of data, the last block must finish the stream, even if it is empty.
+			CKDWORD blockcount = (filled + c_PackBlockSize - 1u) / c_PackBlockSize;
+			if (is_eof && blockcount == 0u) blockcount = 1u;
+
+			// deflate blocks in workers
+			std::atomic_bool failed(false);
+			CKParallelFor(blockcount, workers, [&](CKDWORD i) -> void {
+				CKDWORD blockpos = i * c_PackBlockSize;
+				CKDWORD blocksize = std::min(c_PackBlockSize, filled - blockpos);
+				CKDWORD blockdictsize = std::min(c_PackDictSize, dictsize + blockpos);
+
+				if (!InternalPackBlock(batch + blockpos - blockdictsize, blockdictsize, batch + blockpos, blocksize,
+					is_eof && i + 1u == blockcount, compressionlevel, blocks[i])) {
+					failed.store(true);
+				}
+			});
+			if (failed.load()) return false;
+			adler = adler32(adler, reinterpret_cast<const Bytef*>(batch), static_cast<uInt>(filled));
+
+			// output blocks in order
+			for (CKDWORD i = 0; i < blockcount; ++i) {
+				if (!output(blocks[i].data(), static_cast<CKDWORD>(blocks[i].size()))) return false;
+			}
+			if (is_eof) break;
+
+			// keep the tail of data as the dictionary of next batch
+			CKDWORD newdictsize = std::min(c_PackDictSize, dictsize + filled);
+			std::memmove(window.data(), batch + filled - newdictsize, newdictsize);
+			dictsize = newdictsize;
+		}
+
+		// write adler32 in big endian
+		CKBYTE ztrailer[4] {
+			static_cast<CKBYTE>((adler >> 24) & 0xFFu),
+			static_cast<CKBYTE>((adler >> 16) & 0xFFu),
+			static_cast<CKBYTE>((adler >> 8) & 0xFFu),
+			static_cast<CKBYTE>(adler & 0xFFu)
+		};
+		if (!output(ztrailer, CKSizeof(ztrailer))) return false;
+
+		NewSize = static_cast<CKDWORD>(totalsize);
+		return true;
+	}
+
 	void* CKUnPackData(CKDWORD DestSize, const void* SrcBuffer, CKDWORD SrcSize) {
 		// check argument
 		if (SrcBuffer == nullptr && SrcSize != 0u)
@@ -77,16 +327,92 @@ namespace LibCmo::CK2 {
 		return DestBuffer.release();
 	}
 
-	CKDWORD CKComputeDataCRC(const void* data, CKDWORD size, CKDWORD PreviousCRC) {
+	bool CKUnPackDataProgressive(void* DestBuffer, CKDWORD DestSize, const void* SrcBuffer, CKDWORD SrcSize,
+		CKDWORD WindowSize, CKUnPackProgressFct Progress) {
+		// check argument
+		if (DestBuffer == nullptr && DestSize != 0u)
+			throw LogicException("Buffer passed in CKUnPackDataProgressive should not be nullptr.");
+		if (SrcBuffer == nullptr && SrcSize != 0u)
+			throw LogicException("Data passed in CKUnPackDataProgressive should not be nullptr.");
+		if (WindowSize == 0u)
+			throw LogicException("Window size passed in CKUnPackDataProgressive should not be zero.");
+
+		z_stream strm;
+		std::memset(&strm, 0, sizeof(z_stream));
+		if (inflateInit(&strm) != Z_OK) return false;
+		strm.next_in = const_cast<Bytef*>(static_cast<const Bytef*>(SrcBuffer));
+		strm.avail_in = static_cast<uInt>(SrcSize);
+
+		bool ok = false;
+		CKBYTE* dest = static_cast<CKBYTE*>(DestBuffer);
+		while (true) {
+			// limit output size to window
+			CKDWORD produced = static_cast<CKDWORD>(strm.total_out);
+			strm.next_out = reinterpret_cast<Bytef*>(dest + produced);
+			strm.avail_out = static_cast<uInt>(std::min(WindowSize, DestSize - produced));
+
+			int ret = inflate(&strm, Z_NO_FLUSH);
+			// report progress if we have new data
+			if (Progress != nullptr && static_cast<CKDWORD>(strm.total_out) != produced) {
+				Progress(static_cast<CKDWORD>(strm.total_out));
+			}
+
+			// Z_STREAM_END means success.
+			// Z_OK means we can go on.
+			// any other value, including Z_BUF_ERROR which is caused by insufficient data or buffer, is failure.
+			if (ret == Z_STREAM_END) {
+				ok = true;
+				break;
+			}
+			if (ret != Z_OK) break;
+		}
+
+		inflateEnd(&strm);
+		return ok;
+	}
+
+	CKDWORD CKComputeDataCRC(const void* data, CKDWORD size, CKDWORD PreviousCRC, CKDWORD workers) {
 		// check argument
 		if (data == nullptr && size != 0u)
 			throw LogicException("Data passed in CKComputeDataCRC should not be nullptr.");
 
-		// compute
-		return static_cast<CKDWORD>(adler32(
+		// compute in one pass if there is only one worker or data is not large enough.
+		workers = CKGetWorkerCount(workers);
+		if (workers <= 1u || size <= c_CRCBlockSize) {
+			return static_cast<CKDWORD>(adler32(
+				static_cast<uLong>(PreviousCRC),
+				static_cast<const Bytef*>(data),
+				static_cast<uInt>(size)
+				));
+		}
+
+		// otherwise compute standalone adler32 for each block in workers
+		const CKBYTE* bytes = static_cast<const CKBYTE*>(data);
+		CKDWORD blockcount = (size + c_CRCBlockSize - 1u) / c_CRCBlockSize;
+		XContainer::XArray<CKDWORD> blockcrcs(blockcount);
+		CKParallelFor(blockcount, workers, [&](CKDWORD i) -> void {
+			CKDWORD blockpos = i * c_CRCBlockSize;
+			CKDWORD blocksize = std::min(c_CRCBlockSize, size - blockpos);
+			blockcrcs[i] = static_cast<CKDWORD>(adler32(
+				adler32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(bytes + blockpos), static_cast<uInt>(blocksize)));
+		});
+
+		// and chain them after previous CRC
+		CKDWORD crc = PreviousCRC;
+		for (CKDWORD i = 0; i < blockcount; ++i) {
+			CKDWORD blocksize = std::min(c_CRCBlockSize, size - i * c_CRCBlockSize);
+			crc = CKCombineDataCRC(crc, blockcrcs[i], blocksize);
+		}
+		return crc;
+	}
+
+	CKDWORD CKCombineDataCRC(CKDWORD PreviousCRC, CKDWORD StandaloneCRC, CKDWORD size) {
+		// use 64-bit version because z_off_t is 32-bit long on LLP64 platforms (e.g. Windows),
+		// and the size not less than 2 GiB will be truncated.
+		return static_cast<CKDWORD>(adler32_combine64(
 			static_cast<uLong>(PreviousCRC),
-			static_cast<const Bytef*>(data),
-			static_cast<uInt>(size)
+			static_cast<uLong>(StandaloneCRC),
+			static_cast<z_off64_t>(size)
 			));
 	}
 
@@ -142,6 +468,70 @@ namespace LibCmo::CK2 {
 
 #pragma endregion
 
+#pragma region Parallel Utilities
+
+	CKDWORD CKGetWorkerCount(CKDWORD workers) {
+		if (workers == 0u) {
+			// hardware_concurrency() may return 0 if it can not be computed.
+			workers = static_cast<CKDWORD>(std::thread::hardware_concurrency());
+		}
+		return workers == 0u ? 1u : workers;
+	}
+
+	void CKParallelFor(CKDWORD count, CKDWORD workers, CKParallelFct fct) {
+		// check argument
+		if (fct == nullptr)
+			throw LogicException("Function passed in CKParallelFor should not be nullptr.");
+
+		// limit worker count by item count
+		workers = std::min(CKGetWorkerCount(workers), count);
+		// do it sequentially if no need to create extra threads
+		if (workers <= 1u) {
+			for (CKDWORD i = 0; i < count; ++i) {
+				fct(i);
+			}
+			return;
+		}
+
+		// each worker fetch next unprocessed item until all items are processed or any exception raised.
+		std::atomic<CKDWORD> next(0u);
+		std::atomic_bool cancelled(false);
+		std::exception_ptr first_exception(nullptr);
+		std::mutex exception_mutex;
+		auto worker = [&]() -> void {
+			while (!cancelled.load(std::memory_order_relaxed)) {
+				CKDWORD i = next.fetch_add(1u, std::memory_order_relaxed);
+				if (i >= count) break;
+
+				try {
+					fct(i);
+				} catch (...) {
+					std::lock_guard<std::mutex> locker(exception_mutex);
+					if (first_exception == nullptr) first_exception = std::current_exception();
+					cancelled.store(true, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		// create extra threads and use caller thread as the last worker.
+		XContainer::XArray<std::thread> threads;
+		threads.reserve(workers - 1u);
+		for (CKDWORD i = 1u; i < workers; ++i) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		// re-throw exception if any
+		if (first_exception != nullptr) {
+			std::rethrow_exception(first_exception);
+		}
+	}
+
+#pragma endregion
+
 #pragma region CKClass Registration
 
 	static XContainer::XArray<CKClassDesc> g_CKClassInfo;
@@ -256,6 +646,51 @@ namespace LibCmo::CK2 {
 		return result;
 	}
 
+	XContainer::XBitArray CKGetLoadDependencyClassID(const XContainer::XArray<CK_CLASSID>& cids) {
+		XContainer::XBitArray result;
+		CKDWORD classCount = CKGetClassCount();
+		XContainer::NSXBitArray::Resize(result, classCount);
+
+		XContainer::XArray<CKDWORD> pending;
+		auto addClass = [&result, &pending](CKDWORD idx) -> void {
+			if (XContainer::NSXBitArray::IsSet(result, idx)) return;
+			XContainer::NSXBitArray::Set(result, idx);
+			pending.emplace_back(idx);
+		};
+
+		// add given classes and their derived classes
+		for (auto cid : cids) {
+			const CKClassDesc* desc = CKGetClassDesc(cid);
+			if (desc == nullptr) continue;
+
+			for (CKDWORD idx = 0; idx < classCount; ++idx) {
+				if (XContainer::NSXBitArray::IsSet(desc->Children, idx)) addClass(idx);
+			}
+		}
+
+		// add dependencies until no new class is added.
+		// use ToBeNotify of self and parents, not CommonToBeNotify,
+		// because CommonToBeNotify is expanded to all derived classes of depended class.
+		while (!pending.empty()) {
+			CKDWORD current = pending.back();
+			pending.pop_back();
+			const CKClassDesc& desc = g_CKClassInfo[current];
+
+			for (CKDWORD parent = 0; parent < classCount; ++parent) {
+				if (!XContainer::NSXBitArray::IsSet(desc.Parents, parent)) continue;
+				// group only listens to members. it is not a dependency.
+				if (parent == static_cast<CKDWORD>(CK_CLASSID::CKCID_GROUP)) continue;
+
+				const CKClassDesc& parentDesc = g_CKClassInfo[parent];
+				for (CKDWORD idx = 0; idx < classCount; ++idx) {
+					if (XContainer::NSXBitArray::IsSet(parentDesc.ToBeNotify, idx)) addClass(idx);
+				}
+			}
+		}
+
+		return result;
+	}
+
 #pragma endregion
 
 #pragma region Initializations functions
@@ -421,6 +856,30 @@ namespace LibCmo::CK2 {
 			CKClassNeedNotificationFrom(thiscid, *it);
 		}
 	}
+	/**
+	 * @brief Create object in the memory provided by the slab allocator of CKObjectManager.
+	*/
+	template<class T>
+	static ObjImpls::CKObject* SlabCreateObject(CKContext* ctx, CK_CLASSID cid, CK_ID id, CKSTRING name) {
+		MgrImpls::CKObjectManager* mgr = ctx->GetObjectManager();
+		void* mem = mgr->AllocateObjectMemory(cid, sizeof(T), alignof(T));
+		try {
+			return new (mem) T(ctx, id, name);
+		} catch (...) {
+			mgr->FreeObjectMemory(cid, mem);
+			throw;
+		}
+	}
+	/**
+	 * @brief Destroy object created by SlabCreateObject() and give its memory back.
+	*/
+	template<class T>
+	static void SlabReleaseObject(CKContext* ctx, CK_CLASSID cid, ObjImpls::CKObject* obj) {
+		T* real = static_cast<T*>(obj);
+		real->~T();
+		ctx->GetObjectManager()->FreeObjectMemory(cid, real);
+	}
+
 	CKERROR CKStartUp() {
 		// reserve class info array.
 		g_CKClassInfo.reserve(static_cast<size_t>(CK_CLASSID::CKCID_MAXCLASSID));
@@ -429,14 +888,14 @@ namespace LibCmo::CK2 {
 #define EasyClassReg(clsname, cid, parentCid, strName) \
 CKClassRegister(cid, parentCid, \
 	nullptr, \
-	[](CKContext* ctx, CK_ID id, CKSTRING name) -> ObjImpls::CKObject* { return new clsname(ctx, id, name); }, \
-	[](CKContext* ctx, ObjImpls::CKObject* obj) -> void { delete obj; }, \
+	[](CKContext* ctx, CK_ID id, CKSTRING name) -> ObjImpls::CKObject* { return SlabCreateObject<clsname>(ctx, cid, id, name); }, \
+	[](CKContext* ctx, ObjImpls::CKObject* obj) -> void { SlabReleaseObject<clsname>(ctx, cid, obj); }, \
 	[]() -> CKSTRING { return u8 ## strName; });
 #define EasyClassRegWithNotify(clsname, cid, parentCid, strName, notifyCids) \
 CKClassRegister(cid, parentCid, \
 	[]() -> void { NeedNotificationWrapper(cid, notifyCids); }, \
-	[](CKContext* ctx, CK_ID id, CKSTRING name) -> ObjImpls::CKObject* { return new clsname(ctx, id, name); }, \
-	[](CKContext* ctx, ObjImpls::CKObject* obj) -> void { delete obj; }, \
+	[](CKContext* ctx, CK_ID id, CKSTRING name) -> ObjImpls::CKObject* { return SlabCreateObject<clsname>(ctx, cid, id, name); }, \
+	[](CKContext* ctx, ObjImpls::CKObject* obj) -> void { SlabReleaseObject<clsname>(ctx, cid, obj); }, \
 	[]() -> CKSTRING { return u8 ## strName; });
 
 		EasyClassReg(ObjImpls::CKObject, CK_CLASSID::CKCID_OBJECT, CK_CLASSID::CKCID_OBJECT, "Basic Object");
@@ -459,6 +918,19 @@ CKClassRegister(cid, parentCid, \
 
 		CKBuildClassHierarchyTable();
 
+#if defined(LIBCMO_BUILD_DEBUG)
+		// check that loading groups and mesh data does not pull in 3D entities.
+		{
+			XContainer::XBitArray deps = CKGetLoadDependencyClassID({
+				CK_CLASSID::CKCID_GROUP, CK_CLASSID::CKCID_MESH, CK_CLASSID::CKCID_MATERIAL, CK_CLASSID::CKCID_TEXTURE
+			});
+			for (CKDWORD idx = 0; idx < CKGetClassCount(); ++idx) {
+				if (XContainer::NSXBitArray::IsSet(deps, idx) && CKIsChildClassOf(static_cast<CK_CLASSID>(idx), CK_CLASSID::CKCID_3DENTITY))
+					throw LogicException("Load dependency of mesh data should not include 3D entities.");
+			}
+		}
+#endif
+
 		return CKERROR::CKERR_OK;
 	}
 
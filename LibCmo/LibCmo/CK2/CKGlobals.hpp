@@ -16,16 +16,50 @@ namespace LibCmo::CK2 {
 	 * @param[in] size Size of the source buffer.
 	 * @param[out] NewSize A reference that will be filled with the size of the compressed buffer. 0 if failed.
 	 * @param[in] compressionlevel 0-9 Greater level smaller result size.
+	 * @param[in] workers The count of worker threads used for compression. See CKGetWorkerCount() for its meaning.
 	 * @return 
 	 * A pointer to the compressed buffer. nullptr if failed.
 	 * The return pointer should be freed by \c delete[] manually.
 	 * @remarks
-	 * The size of allocated return value may greater than the passed value of NewSize. 
+	 * \li The size of allocated return value may greater than the passed value of NewSize. 
 	 * NewSize only indicate the size of the part storing useful data in return value.
+	 * \li If there are more than 1 workers and given buffer is large enough,
+	 * the buffer will be split into blocks and each block will be deflated in different workers.
+	 * Each block is primed with the tail of its previous block as dictionary and ended with a sync flush,
+	 * so that all blocks can be concatenated into one standard zlib stream which can be read by CKUnPackData().
 	 * @exception LogicException Raised if given buffer is nullptr and size is not equal to zero.
 	 * @see CKUnPackData(), CKComputeDataCRC()
 	*/
-	void* CKPackData(const void* Data, CKDWORD size, CKDWORD& NewSize, CKINT compressionlevel);
+	void* CKPackData(const void* Data, CKDWORD size, CKDWORD& NewSize, CKINT compressionlevel, CKDWORD workers = 1u);
+	/**
+	 * @brief The callback providing data for CKPackDataStreaming().
+	 * @details
+	 * It accept a buffer and the size of this buffer,
+	 * and return the count of bytes written into given buffer.
+	 * Returning less than requested size means that there is no more data.
+	*/
+	using CKPackSourceFct = std::function<CKDWORD(void*, CKDWORD)>;
+	/**
+	 * @brief The callback receiving compressed data from CKPackDataStreaming().
+	 * @details It accept a pointer to data and the size of data. Return false to stop compression.
+	*/
+	using CKPackSinkFct = std::function<bool(const void*, CKDWORD)>;
+	/**
+	 * @brief Compress data provided by callback and pass the result to another callback progressively.
+	 * @param[in] Source The callback providing data to compress. nullptr is not allowed.
+	 * @param[in] Sink The callback receiving compressed data in order. nullptr is not allowed.
+	 * @param[out] NewSize The size of the whole compressed data. 0 if failed.
+	 * @param[in] compressionlevel 0-9 Greater level smaller result size.
+	 * @param[in] workers The count of worker threads used for compression. See CKGetWorkerCount() for its meaning.
+	 * @return True if success, otherwise false.
+	 * @remarks
+	 * \li Data is read and compressed in batches, so the memory usage is irrelevant to the size of data.
+	 * \li The result is a standard zlib stream which can be read by CKUnPackData(),
+	 * built in the same way as CKPackData() with multiple workers.
+	 * @exception LogicException Raised if given callback is nullptr.
+	 * @see CKPackData()
+	*/
+	bool CKPackDataStreaming(CKPackSourceFct Source, CKPackSinkFct Sink, CKDWORD& NewSize, CKINT compressionlevel, CKDWORD workers = 1u);
 	/**
 	 * @brief Decompress a buffer
 	 * @param[in] DestSize Expected size of the decompressed buffer.
@@ -38,6 +72,28 @@ namespace LibCmo::CK2 {
 	 * @see CKPackData(), CKComputeDataCRC()
 	*/
 	void* CKUnPackData(CKDWORD DestSize, const void* SrcBuffer, CKDWORD SrcSize);
+	/**
+	 * @brief The callback reporting the progress of CKUnPackDataProgressive().
+	 * @details It accept the size of data which has been decompressed into destination buffer so far.
+	*/
+	using CKUnPackProgressFct = std::function<void(CKDWORD)>;
+	/**
+	 * @brief Decompress a buffer into given buffer progressively.
+	 * @param[in] DestBuffer The buffer receiving decompressed data. nullptr is not allowed.
+	 * @param[in] DestSize Expected size of the decompressed buffer.
+	 * @param[in] SrcBuffer Compressed buffer. nullptr is not allowed.
+	 * @param[in] SrcSize Size of the compressed buffer.
+	 * @param[in] WindowSize The maximum size of data decompressed in each step. Must not be zero.
+	 * @param[in] Progress 
+	 * The callback called after each step with the size of decompressed data so far.
+	 * The data located before reported size in destination buffer is ready for use,
+	 * so caller can process them while decompressing. nullptr is allowed.
+	 * @return True if success, otherwise false.
+	 * @exception LogicException Raised if given buffer is nullptr and size is not equal to zero, or window size is zero.
+	 * @see CKUnPackData()
+	*/
+	bool CKUnPackDataProgressive(void* DestBuffer, CKDWORD DestSize, const void* SrcBuffer, CKDWORD SrcSize,
+		CKDWORD WindowSize, CKUnPackProgressFct Progress);
 	/**
 	 * @brief Computes a CRC for a buffer.
 	 * @param[in] data A pointer to the buffer to create a CRC for. nullptr is not allowed.
@@ -46,11 +102,31 @@ namespace LibCmo::CK2 {
 	 * The first time a CRC is computed this value should be 0, 
 	 * but it can be use to compute a single CRC for a several buffers 
 	 * by using the currently computed CRC for previous buffers in this value.
+	 * @param[in] workers The count of worker threads used for computing. See CKGetWorkerCount() for its meaning.
 	 * @return CRC of the buffer.
+	 * @remarks
+	 * If there are more than 1 workers and given buffer is large enough,
+	 * the buffer will be split into blocks and the CRC of each block will be computed in different workers.
+	 * The result is identical to the result computed in one pass.
 	 * @exception LogicException Raised if given buffer is nullptr and size is not equal to zero.
-	 * @see CKPackData(), CKUnPackData()
+	 * @see CKPackData(), CKUnPackData(), CKCombineDataCRC()
+	*/
+	CKDWORD CKComputeDataCRC(const void* data, CKDWORD size, CKDWORD PreviousCRC = 0, CKDWORD workers = 1u);
+	/**
+	 * @brief Chain a standalone CRC of buffer after a previous CRC.
+	 * @param[in] PreviousCRC The CRC computed for previous buffers. It can be any value, including 0.
+	 * @param[in] StandaloneCRC
+	 * The standalone CRC of the next buffer,
+	 * which must be computed by CKComputeDataCRC() with \c PreviousCRC set to \c 1 (the initial value of adler32).
+	 * @param[in] size The size of the next buffer.
+	 * @return
+	 * The CRC which is identical to calling CKComputeDataCRC() for the next buffer with given previous CRC.
+	 * @remarks
+	 * This function is useful when the CRC of the same buffer need to be computed with different previous CRC.
+	 * The CRC of buffer only need to be computed once, then it can be chained after each previous CRC cheaply.
+	 * @see CKComputeDataCRC()
 	*/
-	CKDWORD CKComputeDataCRC(const void* data, CKDWORD size, CKDWORD PreviousCRC = 0);
+	CKDWORD CKCombineDataCRC(CKDWORD PreviousCRC, CKDWORD StandaloneCRC, CKDWORD size);
 
 	// ========== String Utilities ==========
 
@@ -92,6 +168,31 @@ namespace LibCmo::CK2 {
 	*/
 	CKDWORD CKStrLen(CKSTRING strl);
 
+	// ========== Parallel Utilities ==========
+
+	/// @brief Function pointer which process the item located at given index.
+	using CKParallelFct = std::function<void(CKDWORD)>;
+	/**
+	 * @brief Resolve the real count of workers which can be used.
+	 * @param[in] workers The count of workers requested by user. 0 means use all available hardware threads.
+	 * @return The real count of workers. It always greater than 0.
+	*/
+	CKDWORD CKGetWorkerCount(CKDWORD workers);
+	/**
+	 * @brief Process a series of independent items with given workers.
+	 * @param[in] count The count of items.
+	 * @param[in] workers The count of workers requested by user. 0 means use all available hardware threads.
+	 * @param[in] fct The function processing the item located at given index. nullptr is not allowed.
+	 * @remarks
+	 * \li Caller thread is also a worker. So if the real count of workers is 1, no extra threads will be created
+	 * and all items will be processed in caller thread sequentially.
+	 * \li The order of processing items is not guaranteed. Given function should not depend on it.
+	 * \li If given function throw exception, the rest of items will not be processed
+	 * and the first thrown exception will be re-thrown in caller thread after all workers exit.
+	 * @exception LogicException Raised if given function is nullptr.
+	*/
+	void CKParallelFor(CKDWORD count, CKDWORD workers, CKParallelFct fct);
+
 	// ========== Class registration utilities ==========
 
 	/// @brief Function pointer which do extra stuff when registry this class.
@@ -239,6 +340,18 @@ namespace LibCmo::CK2 {
 	 * @see CKIsNeedNotify()
 	*/
 	XContainer::XBitArray CKGetAllNotifyClassID(const XContainer::XBitArray& delObjCids);
+	/**
+	 * @brief Get all class ids need to be loaded for loading objects whose class id included in \c cids.
+	 * @param[in] cids The class ids which need to be loaded. Their derived classes are also included.
+	 * @return The bit array representing given class ids and the class ids they depend on.
+	 * @remarks
+	 * \li The dependency is the explicit notification relation registered by CKClassNeedNotificationFrom()
+	 * for the class and its parents. It is not expanded to the derived classes of the depended class,
+	 * so the class which references CKCID_3DENTITY does not pull in every 3D object, light and camera.
+	 * \li CKCID_GROUP is registered to be notified by all CKCID_BEOBJECT only for removing deleted members.
+	 * This relation is not a dependency because group can be loaded without its members.
+	*/
+	XContainer::XBitArray CKGetLoadDependencyClassID(const XContainer::XArray<CK_CLASSID>& cids);
 
 	// ========== Initializations Functions ==========
 
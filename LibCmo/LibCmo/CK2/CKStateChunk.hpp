@@ -5,9 +5,54 @@
 #include <memory>
 #include <functional>
 #include <type_traits>
+#include <mutex>
 
 namespace LibCmo::CK2 {
 
+	/**
+	 * @brief The pool of CKStateChunk data buffers.
+	 * @details
+	 * The CKStateChunk bound with this pool will acquire its buffer from this pool when writing,
+	 * and give it back to this pool when writing is stopped, instead of calling allocator in every growth.
+	 * The size of all buffers in this pool is the power of 2 in CKDWORD unit.
+	 * @remarks
+	 * \li This pool is thread-safe.
+	 * \li This pool must outlive all CKStateChunk bound with it.
+	*/
+	class CKStateChunkBufferPool {
+	public:
+		CKStateChunkBufferPool();
+		~CKStateChunkBufferPool();
+		YYCC_DELETE_COPY_MOVE(CKStateChunkBufferPool)
+
+		/**
+		 * @brief Acquire a buffer from this pool.
+		 * @param[in] min_dwsize The minimum size of requested buffer in CKDWORD unit.
+		 * @param[out] real_dwsize The real size of returned buffer in CKDWORD unit.
+		 * @return The acquired buffer. It should be given back by Release().
+		 * @exception RuntimeException Raised if requested size is too large.
+		*/
+		CKDWORD* Acquire(CKDWORD min_dwsize, CKDWORD& real_dwsize);
+		/**
+		 * @brief Give a buffer acquired from this pool back.
+		 * @param[in] buf The buffer acquired from this pool. nullptr is allowed.
+		 * @param[in] dwsize The real size of this buffer returned by Acquire().
+		*/
+		void Release(CKDWORD* buf, CKDWORD dwsize);
+		/**
+		 * @brief Free all idle buffers in this pool.
+		*/
+		void Clear();
+
+	private:
+		std::mutex m_Mutex;
+		/**
+		 * @brief The idle buffers grouped by size.
+		 * @details The buffers located in index N have the size of 2 ^ N CKDWORD.
+		*/
+		XContainer::XArray<XContainer::XArray<CKDWORD*>> m_IdleBuffers;
+	};
+
 	/**
 	 * @remark
 	 * + We make sure m_BindContext and m_BindFile always are not nullptr. So some code of BindFile check and write different data struct has been removed.
@@ -49,6 +94,15 @@ namespace LibCmo::CK2 {
 			void* m_DataPtr;
 			CKDWORD m_AreaSize;
 		};
+		/**
+		 * @brief The statistics of identifier seeking shared by all CKStateChunk.
+		 * @details It is usually used for instrumentation when loading file.
+		*/
+		struct SeekStatistics_t {
+			CKQWORD m_SeekCount; /**< How many times identifier seeking is performed. */
+			CKQWORD m_IndexBuildCount; /**< How many times identifier index is built. */
+			CKQWORD m_IndexedIdentifierCount; /**< How many identifiers are added into identifier index totally. */
+		};
 
 		class LockedReadBufferDeleter {
 		public:
@@ -112,6 +166,13 @@ namespace LibCmo::CK2 {
 			CKDWORD m_DataSize;
 			CKDWORD m_PrevIdentifierPos;
 		};
+		/**
+		 * @brief The item of identifier index.
+		*/
+		struct IdentifierIndex_t {
+			CKDWORD m_Identifier; /**< The identifier. */
+			CKDWORD m_Pos; /**< The position of identifier header in data buffer in DWORD unit. */
+		};
 
 #pragma endregion
 
@@ -120,11 +181,39 @@ namespace LibCmo::CK2 {
 		CK_CLASSID m_ClassId;
 		CKDWORD m_DataDwSize;
 		CKDWORD* m_pData;
+		/**
+		 * @brief The external buffer borrowed by this CKStateChunk.
+		 * @details
+		 * nullptr if m_pData is owned by this CKStateChunk.
+		 * Otherwise, m_pData points into this buffer and should not be modified or freed,
+		 * and 3 entry lists are not loaded until this CKStateChunk is detached from this buffer.
+		 * @see BorrowFromBuffer(), DetachBorrowedBuffer()
+		*/
+		const void* m_BorrowedBuffer;
+		/**
+		 * @brief The real size of m_pData in CKDWORD unit.
+		 * @details It may greater than m_DataDwSize because buffer grows geometrically when writing.
+		*/
+		CKDWORD m_DataDwCapacity;
+		/**
+		 * @brief The pool used for allocating writing buffer.
+		 * @details nullptr if writing buffer should be allocated by allocator directly.
+		 * @see SetBufferPool()
+		*/
+		CKStateChunkBufferPool* m_BufferPool;
+		bool m_IsPooledData; /**< True if m_pData is acquired from m_BufferPool. */
 
 		CK_STATECHUNK_DATAVERSION m_DataVersion;
 		CK_STATECHUNK_CHUNKVERSION m_ChunkVersion;
 
 		ChunkParser m_Parser;
+		/**
+		 * @brief The identifier index sorted by identifier, used for fast identifier seeking in read mode.
+		 * @details It is built when seeking identifier first time after StartRead(), and cleared by StopRead().
+		 * @see BuildIdentifierIndex()
+		*/
+		XContainer::XArray<IdentifierIndex_t> m_IdentifierIndex;
+		bool m_IsIdentifierIndexBuilt; /**< True if m_IdentifierIndex is ready for current reading. */
 
 		XContainer::XArray<CKDWORD> m_ObjectList;
 		XContainer::XArray<CKDWORD> m_ChunkList;
@@ -139,8 +228,44 @@ namespace LibCmo::CK2 {
 
 	public:
 		bool ConvertFromBuffer(const void* buf);
+		/**
+		 * @brief Load this CKStateChunk from given buffer without copying its data.
+		 * @param[in] buf The buffer holding a CKStateChunk. nullptr is not allowed.
+		 * @return True if success.
+		 * @remarks
+		 * \li Given buffer must outlive this CKStateChunk, or at least live until this CKStateChunk is cleared or written.
+		 * \li Borrowed data is never modified. Any operation requiring a mutable or complete CKStateChunk
+		 * (writing, copying, converting to buffer and etc.) will copy borrowed data first automatically.
+		 * \li If given buffer is not aligned to CKDWORD, this function will copy data like ConvertFromBuffer().
+		 * @see ConvertFromBuffer(), IsBorrowed()
+		*/
+		bool BorrowFromBuffer(const void* buf);
+		/**
+		 * @brief Check whether this CKStateChunk is borrowing an external buffer.
+		 * @return True if it is, otherwise false.
+		*/
+		bool IsBorrowed() const;
+		/**
+		 * @brief Set the pool used for allocating writing buffer.
+		 * @param[in] pool The pool. nullptr to allocate buffer by allocator directly.
+		 * @remarks
+		 * \li This function only can be called when this CKStateChunk has no data. Otherwise it do nothing.
+		 * \li The buffer acquired from pool is only used while writing.
+		 * StopWrite() copies written data into a buffer with exact size and gives the pooled one back,
+		 * so the pool holds at most the buffers of chunks being written at the same time.
+		*/
+		void SetBufferPool(CKStateChunkBufferPool* pool);
 		CKDWORD ConvertToBuffer(void* buf);
 
+	private:
+		bool InternalConvertFromBuffer(const void* buf, bool borrow);
+		/**
+		 * @brief Copy borrowed data into self owned buffer and load all entry lists.
+		 * @details Do nothing if this CKStateChunk is not borrowing any buffer.
+		 * Parser status will be kept after detaching.
+		*/
+		void DetachBorrowedBuffer();
+
 #pragma endregion
 
 #pragma region Misc Functions
@@ -183,6 +308,12 @@ namespace LibCmo::CK2 {
 		 * @remark Frequently used when saving someing in CKStateChunk.
 		*/
 		void SetDataVersion(CK_STATECHUNK_DATAVERSION version);
+		/**
+		 * @brief Get chunk version in this CKStateChunk.
+		 * @remark Chunk version indicates the layout of CKStateChunk itself, not the layout of data stored in it.
+		 * @return The chunk version.
+		*/
+		CK_STATECHUNK_CHUNKVERSION GetChunkVersion() const;
 		/**
 		 * @brief Get associated CK_CLASSID of this CKStateChunk
 		 * @return Associated CK_CLASSID
@@ -211,6 +342,11 @@ namespace LibCmo::CK2 {
 		 * @return The size in DWORD unit.
 		*/
 		CKDWORD GetCeilDwordSize(size_t char_size);
+		/**
+		 * @brief Free data buffer if it is owned by self, or stop borrowing it.
+		 * @details m_pData will be set to nullptr after calling this function.
+		*/
+		void FreeBuffer();
 		bool ResizeBuffer(CKDWORD new_dwsize);
 		/**
 		 * @brief Check whether there are enough buffer to read.
@@ -273,6 +409,16 @@ namespace LibCmo::CK2 {
 
 	public:
 		bool SeekIdentifierDword(CKDWORD identifier);
+		/**
+		 * @brief Seek to the data area of given identifier.
+		 * @param[in] identifier The identifier to be found.
+		 * @param[out] out_size The pointer receiving the size of data area in byte. nullptr is not allowed.
+		 * @return True if success.
+		 * @remarks
+		 * \li If there are multiple identifiers with the same value, the first one will be picked.
+		 * \li The first calling after StartRead() will build an identifier index, then all following seeking
+		 * are performed by binary search on this index instead of walking identifier linked list from head.
+		*/
 		bool SeekIdentifierDwordAndReturnSize(CKDWORD identifier, CKDWORD* out_size);
 		template<typename TEnum>
 			requires std::is_enum_v<TEnum>
@@ -285,6 +431,23 @@ namespace LibCmo::CK2 {
 			return SeekIdentifierDwordAndReturnSize(static_cast<CKDWORD>(enum_v), out_size);
 		}
 
+		/**
+		 * @brief Get the identifier seeking statistics shared by all CKStateChunk.
+		 * @return The statistics.
+		*/
+		static SeekStatistics_t GetSeekStatistics();
+		/**
+		 * @brief Reset the identifier seeking statistics shared by all CKStateChunk.
+		*/
+		static void ResetSeekStatistics();
+
+	private:
+		/**
+		 * @brief Build identifier index from identifier linked list in data buffer.
+		 * @details The building will stop at broken link (out of buffer or pointing backward).
+		*/
+		void BuildIdentifierIndex();
+
 		/* ========== Read Buffer Controller ==========*/
 
 	public:
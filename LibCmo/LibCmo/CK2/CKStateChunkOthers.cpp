@@ -2,40 +2,112 @@
 #include "CKFile.hpp"
 #include "CKContext.hpp"
 #include <yycc/cenum.hpp>
+#include <bit>
+#include <limits>
 
 namespace LibCmo::CK2 {
 
+#pragma region CKStateChunkBufferPool
+
+	CKStateChunkBufferPool::CKStateChunkBufferPool() :
+		m_Mutex(), m_IdleBuffers() {}
+
+	CKStateChunkBufferPool::~CKStateChunkBufferPool() {
+		this->Clear();
+	}
+
+	CKDWORD* CKStateChunkBufferPool::Acquire(CKDWORD min_dwsize, CKDWORD& real_dwsize) {
+		// round up size to the power of 2
+		if (min_dwsize > (std::numeric_limits<CKDWORD>::max() >> 1) + 1u)
+			throw RuntimeException("Requested size is too large for CKStateChunkBufferPool.");
+		real_dwsize = std::bit_ceil(min_dwsize);
+		size_t index = static_cast<size_t>(std::countr_zero(real_dwsize));
+
+		// try picking idle one
+		{
+			std::lock_guard<std::mutex> locker(this->m_Mutex);
+			if (index < this->m_IdleBuffers.size() && !this->m_IdleBuffers[index].empty()) {
+				CKDWORD* buf = this->m_IdleBuffers[index].back();
+				this->m_IdleBuffers[index].pop_back();
+				return buf;
+			}
+		}
+
+		// no idle one, allocate it
+		return new CKDWORD[real_dwsize];
+	}
+
+	void CKStateChunkBufferPool::Release(CKDWORD* buf, CKDWORD dwsize) {
+		if (buf == nullptr) return;
+		if (!std::has_single_bit(dwsize))
+			throw LogicException("Given buffer is not acquired from CKStateChunkBufferPool.");
+		size_t index = static_cast<size_t>(std::countr_zero(dwsize));
+
+		std::lock_guard<std::mutex> locker(this->m_Mutex);
+		if (index >= this->m_IdleBuffers.size()) {
+			this->m_IdleBuffers.resize(index + 1u);
+		}
+		this->m_IdleBuffers[index].emplace_back(buf);
+	}
+
+	void CKStateChunkBufferPool::Clear() {
+		std::lock_guard<std::mutex> locker(this->m_Mutex);
+		for (auto& bufs : this->m_IdleBuffers) {
+			for (auto& buf : bufs) {
+				delete[] buf;
+			}
+		}
+		this->m_IdleBuffers.clear();
+	}
+
+#pragma endregion
+
 #pragma region Ctor Dtor
 
 	CKStateChunk::CKStateChunk(CKFileVisitor* visitor, CKContext* ctx) :
-		m_ClassId(CK_CLASSID::CKCID_OBJECT), m_DataDwSize(0u), m_pData(nullptr),
+		m_ClassId(CK_CLASSID::CKCID_OBJECT), m_DataDwSize(0u), m_pData(nullptr), m_BorrowedBuffer(nullptr),
+		m_DataDwCapacity(0u), m_BufferPool(nullptr), m_IsPooledData(false),
 		m_DataVersion(CK_STATECHUNK_DATAVERSION::CHUNKDATA_CURRENTVERSION), m_ChunkVersion(CK_STATECHUNK_CHUNKVERSION::CHUNK_VERSION4),
 		m_Parser { CKStateChunkStatus::IDLE, 0u, 0u, 0u },
+		m_IdentifierIndex(), m_IsIdentifierIndexBuilt(false),
 		m_ObjectList(), m_ChunkList(), m_ManagerList(),
 		m_BindFile(visitor), m_BindContext(ctx)
 	{}
 
 	CKStateChunk::CKStateChunk(const CKStateChunk& rhs) :
-		m_ClassId(rhs.m_ClassId), m_DataVersion(rhs.m_DataVersion), m_ChunkVersion(rhs.m_ChunkVersion),
+		m_ClassId(rhs.m_ClassId), m_DataDwSize(rhs.m_DataDwSize), m_pData(nullptr), m_BorrowedBuffer(nullptr),
+		m_DataDwCapacity(0u), m_BufferPool(nullptr), m_IsPooledData(false),
+		m_DataVersion(rhs.m_DataVersion), m_ChunkVersion(rhs.m_ChunkVersion),
 		m_Parser(rhs.m_Parser),
-		m_ObjectList(rhs.m_ObjectList), m_ManagerList(rhs.m_ManagerList), m_ChunkList(rhs.m_ChunkList),
-		m_pData(nullptr), m_DataDwSize(rhs.m_DataDwSize),
+		m_IdentifierIndex(), m_IsIdentifierIndexBuilt(false),
+		m_ObjectList(rhs.m_ObjectList), m_ChunkList(rhs.m_ChunkList), m_ManagerList(rhs.m_ManagerList),
 		m_BindFile(rhs.m_BindFile), m_BindContext(rhs.m_BindContext) {
-		// copy buffer
-		if (rhs.m_pData != nullptr) {
+		if (rhs.m_BorrowedBuffer != nullptr) {
+			// borrow the same buffer first, then detach from it to get a complete copy.
+			// because the entry lists of borrowed CKStateChunk are not loaded.
+			this->m_pData = rhs.m_pData;
+			this->m_BorrowedBuffer = rhs.m_BorrowedBuffer;
+			this->DetachBorrowedBuffer();
+		} else if (rhs.m_pData != nullptr) {
+			// copy buffer
 			this->m_pData = new CKDWORD[rhs.m_DataDwSize];
+			this->m_DataDwCapacity = rhs.m_DataDwSize;
 				std::memcpy(this->m_pData, rhs.m_pData, sizeof(CKDWORD) * rhs.m_DataDwSize);
 		}
 	}
 
 	CKStateChunk::CKStateChunk(CKStateChunk&& rhs) :
-		m_ClassId(rhs.m_ClassId), m_DataVersion(rhs.m_DataVersion), m_ChunkVersion(rhs.m_ChunkVersion),
+		m_ClassId(rhs.m_ClassId), m_DataDwSize(rhs.m_DataDwSize), m_pData(rhs.m_pData), m_BorrowedBuffer(rhs.m_BorrowedBuffer),
+		m_DataDwCapacity(rhs.m_DataDwCapacity), m_BufferPool(rhs.m_BufferPool), m_IsPooledData(rhs.m_IsPooledData),
+		m_DataVersion(rhs.m_DataVersion), m_ChunkVersion(rhs.m_ChunkVersion),
 		m_Parser(rhs.m_Parser),
-		m_ObjectList(std::move(rhs.m_ObjectList)), m_ManagerList(std::move(rhs.m_ManagerList)), m_ChunkList(std::move(rhs.m_ChunkList)),
-		m_pData(rhs.m_pData), m_DataDwSize(rhs.m_DataDwSize),
+		m_IdentifierIndex(), m_IsIdentifierIndexBuilt(false),
+		m_ObjectList(std::move(rhs.m_ObjectList)), m_ChunkList(std::move(rhs.m_ChunkList)), m_ManagerList(std::move(rhs.m_ManagerList)),
 		m_BindFile(rhs.m_BindFile), m_BindContext(rhs.m_BindContext) {
 		// set to null after steal data
 		rhs.m_pData = nullptr;
+		rhs.m_BorrowedBuffer = nullptr;
+		rhs.m_IsPooledData = false;
 		// and clear it
 		rhs.Clear();
 	}
@@ -48,6 +120,8 @@ namespace LibCmo::CK2 {
 		this->m_ClassId = rhs.m_ClassId;
 
 		this->m_Parser = rhs.m_Parser;
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = false;
 
 		this->m_ObjectList = rhs.m_ObjectList;
 		this->m_ManagerList = rhs.m_ManagerList;
@@ -56,12 +130,18 @@ namespace LibCmo::CK2 {
 		this->m_BindFile = rhs.m_BindFile;
 		this->m_BindContext = rhs.m_BindContext;
 
-		// copy buffer
-		if (rhs.m_pData != nullptr) {
+		this->m_DataDwSize = rhs.m_DataDwSize;
+		if (rhs.m_BorrowedBuffer != nullptr) {
+			// same as copy constructor, borrow it first and then detach.
+			this->m_pData = rhs.m_pData;
+			this->m_BorrowedBuffer = rhs.m_BorrowedBuffer;
+			this->DetachBorrowedBuffer();
+		} else if (rhs.m_pData != nullptr) {
+			// copy buffer
 			this->m_pData = new CKDWORD[rhs.m_DataDwSize];
+			this->m_DataDwCapacity = rhs.m_DataDwSize;
 				std::memcpy(this->m_pData, rhs.m_pData, sizeof(CKDWORD) * rhs.m_DataDwSize);
 		}
-		this->m_DataDwSize = rhs.m_DataDwSize;
 
 		return *this;
 	}
@@ -74,6 +154,8 @@ namespace LibCmo::CK2 {
 		this->m_ClassId = rhs.m_ClassId;
 
 		this->m_Parser = rhs.m_Parser;
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = false;
 
 		this->m_ObjectList = rhs.m_ObjectList;
 		this->m_ManagerList = rhs.m_ManagerList;
@@ -83,8 +165,15 @@ namespace LibCmo::CK2 {
 		this->m_BindContext = rhs.m_BindContext;
 
 		// steal buffer
+		// pool should also be stolen because pooled buffer should be given back to its original pool.
 		this->m_pData = rhs.m_pData;
+		this->m_BorrowedBuffer = rhs.m_BorrowedBuffer;
+		this->m_DataDwCapacity = rhs.m_DataDwCapacity;
+		this->m_BufferPool = rhs.m_BufferPool;
+		this->m_IsPooledData = rhs.m_IsPooledData;
 		rhs.m_pData = nullptr;
+		rhs.m_BorrowedBuffer = nullptr;
+		rhs.m_IsPooledData = false;
 		this->m_DataDwSize = rhs.m_DataDwSize;
 
 		// clear steal chunk
@@ -94,8 +183,7 @@ namespace LibCmo::CK2 {
 	}
 
 	CKStateChunk::~CKStateChunk() {
-		if (this->m_pData != nullptr)
-			delete[] this->m_pData;
+		this->FreeBuffer();
 	}
 
 #pragma endregion
@@ -136,6 +224,9 @@ namespace LibCmo::CK2 {
 	// ========== Public Funcs ==========
 
 	const CKStateChunk::ProfileStateChunk_t CKStateChunk::GetStateChunkProfile() {
+		// entry lists are required.
+		this->DetachBorrowedBuffer();
+
 		return CKStateChunk::ProfileStateChunk_t {
 			.m_ClassId = this->m_ClassId,
 			.m_DataDwSize = this->m_DataDwSize,
@@ -195,12 +286,11 @@ namespace LibCmo::CK2 {
 		this->m_Parser.m_CurrentPos = 0;
 		this->m_Parser.m_DataSize = 0;
 		this->m_Parser.m_PrevIdentifierPos = 0;
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = false;
 
 		this->m_DataDwSize = 0;
-		if (this->m_pData != nullptr) {
-			delete[] this->m_pData;
-			this->m_pData = nullptr;
-		}
+		this->FreeBuffer();
 
 		this->m_ObjectList.clear();
 		this->m_ManagerList.clear();
@@ -215,6 +305,10 @@ namespace LibCmo::CK2 {
 		return this->m_DataVersion;
 	}
 
+	CK_STATECHUNK_CHUNKVERSION CKStateChunk::GetChunkVersion() const {
+		return this->m_ChunkVersion;
+	}
+
 	void CKStateChunk::SetDataVersion(CK_STATECHUNK_DATAVERSION version) {
 		this->m_DataVersion = version;
 	}
@@ -255,33 +349,52 @@ namespace LibCmo::CK2 {
 		return static_cast<CKDWORD>((char_size + 3) >> 2);
 	}
 
+	void CKStateChunk::FreeBuffer() {
+		// borrowed buffer is not owned by us. just drop it.
+		if (this->m_pData != nullptr && this->m_BorrowedBuffer == nullptr) {
+			if (this->m_IsPooledData) {
+				this->m_BufferPool->Release(this->m_pData, this->m_DataDwCapacity);
+			} else {
+				delete[] this->m_pData;
+			}
+		}
+		this->m_pData = nullptr;
+		this->m_BorrowedBuffer = nullptr;
+		this->m_DataDwCapacity = 0u;
+		this->m_IsPooledData = false;
+	}
+
 	bool CKStateChunk::ResizeBuffer(CKDWORD new_dwsize) {
 		if (new_dwsize == 0u) {
 			// if reuqired size is zero, we just delete it
-			if (this->m_pData != nullptr) {
-				delete[] this->m_pData;
-				this->m_pData = nullptr;
-			}
+			this->FreeBuffer();
 
 			// set buf size
 			this->m_Parser.m_DataSize = 0u;
 		} else {
-			// otherwise, we create a new buffer instead it
-			CKDWORD* newbuf = new CKDWORD[new_dwsize];
+			// otherwise, we create a new buffer instead it.
+			// pick it from pool if we have, and pool may give us a larger buffer.
+			CKDWORD newbuf_dwsize = new_dwsize;
+			CKDWORD* newbuf = nullptr;
+			bool is_pooled = this->m_BufferPool != nullptr;
+			if (is_pooled) newbuf = this->m_BufferPool->Acquire(new_dwsize, newbuf_dwsize);
+			else newbuf = new CKDWORD[new_dwsize];
 
 			// we copy original data only when it has.
 			if (this->m_pData != nullptr) {
 				// MARK: use std::min to copy for the minilist one
 				// otherwise, EnsureWriteSpace or StopWrite will crash.
 				std::memcpy(newbuf, this->m_pData, sizeof(CKDWORD) * std::min(this->m_Parser.m_DataSize, new_dwsize));
-				delete[] this->m_pData;
+				this->FreeBuffer();
 			}
 
 			// assign new buffer
 			this->m_pData = newbuf;
+			this->m_DataDwCapacity = newbuf_dwsize;
+			this->m_IsPooledData = is_pooled;
 
 			// set buf size
-			this->m_Parser.m_DataSize = new_dwsize;
+			this->m_Parser.m_DataSize = newbuf_dwsize;
 		}
 
 		return true;
@@ -296,6 +409,11 @@ namespace LibCmo::CK2 {
 			// add a very enough space to buffer
 			if (dwsize < 512) dwsize = 512;
 			needed = dwsize + this->m_Parser.m_CurrentPos;
+			// grow geometrically to avoid copying the whole buffer in each growth.
+			// doubling is skipped if it overflows.
+			if (this->m_Parser.m_DataSize <= (std::numeric_limits<CKDWORD>::max() >> 1)) {
+				needed = std::max(needed, this->m_Parser.m_DataSize << 1);
+			}
 
 			// try resizing it
 			if (!this->ResizeBuffer(needed)) return false;
@@ -323,6 +441,35 @@ namespace LibCmo::CK2 {
 #pragma region Buffer Related
 
 	bool CKStateChunk::ConvertFromBuffer(const void* buf) {
+		return this->InternalConvertFromBuffer(buf, false);
+	}
+
+	bool CKStateChunk::BorrowFromBuffer(const void* buf) {
+		// we can not borrow unaligned buffer, because data buffer is accessed in CKDWORD unit.
+		bool aligned = reinterpret_cast<std::uintptr_t>(buf) % alignof(CKDWORD) == 0u;
+		return this->InternalConvertFromBuffer(buf, aligned);
+	}
+
+	bool CKStateChunk::IsBorrowed() const {
+		return this->m_BorrowedBuffer != nullptr;
+	}
+
+	void CKStateChunk::SetBufferPool(CKStateChunkBufferPool* pool) {
+		if (this->m_pData != nullptr) return;
+		this->m_BufferPool = pool;
+	}
+
+	void CKStateChunk::DetachBorrowedBuffer() {
+		if (this->m_BorrowedBuffer == nullptr) return;
+
+		// load it again with copy, but keep parser status.
+		// data buffer size is not changed, so parser is still valid after this.
+		ChunkParser parser = this->m_Parser;
+		this->InternalConvertFromBuffer(this->m_BorrowedBuffer, false);
+		this->m_Parser = parser;
+	}
+
+	bool CKStateChunk::InternalConvertFromBuffer(const void* buf, bool borrow) {
 		if (buf == nullptr) return false;
 		this->Clear();
 
@@ -336,6 +483,10 @@ namespace LibCmo::CK2 {
 			static_cast<const CKBYTE*>(buf)[0]
 			);
 
+		// entry lists will not be loaded in borrow mode.
+		// they will be loaded from borrowed buffer when detaching.
+		if (borrow) this->m_BorrowedBuffer = buf;
+
 		// switch according to chunk ver
 		const CKDWORD* dwbuf = static_cast<const CKDWORD*>(buf);
 		size_t bufpos = 0u;
@@ -345,22 +496,30 @@ namespace LibCmo::CK2 {
 			this->m_ClassId = static_cast<CK_CLASSID>(dwbuf[1]);
 			this->m_DataDwSize = dwbuf[2];
 
-			this->m_ObjectList.resize(dwbuf[4]);
-			this->m_ChunkList.resize(dwbuf[5]);
+			CKDWORD objlist_size = dwbuf[4], chklist_size = dwbuf[5];
 			bufpos = 6u;
 
 			if (this->m_DataDwSize != 0) {
-				this->m_pData = new CKDWORD[this->m_DataDwSize];
-				std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				if (borrow) {
+					this->m_pData = const_cast<CKDWORD*>(dwbuf + bufpos);
+				} else {
+					this->m_pData = new CKDWORD[this->m_DataDwSize];
+					this->m_DataDwCapacity = this->m_DataDwSize;
+					std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				}
 				bufpos += this->m_DataDwSize;
 			}
-			if (!this->m_ObjectList.empty()) {
-				std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
-				bufpos += this->m_ObjectList.size();
-			}
-			if (!this->m_ChunkList.empty()) {
-				std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
-				bufpos += this->m_ChunkList.size();
+			if (!borrow) {
+				this->m_ObjectList.resize(objlist_size);
+				this->m_ChunkList.resize(chklist_size);
+				if (!this->m_ObjectList.empty()) {
+					std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
+					bufpos += this->m_ObjectList.size();
+				}
+				if (!this->m_ChunkList.empty()) {
+					std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
+					bufpos += this->m_ChunkList.size();
+				}
 			}
 			
 			// no bind file
@@ -372,27 +531,35 @@ namespace LibCmo::CK2 {
 			this->m_ClassId = static_cast<CK_CLASSID>(dwbuf[1]);
 			this->m_DataDwSize = dwbuf[2];
 
-			this->m_ObjectList.resize(dwbuf[4]);
-			this->m_ChunkList.resize(dwbuf[5]);
-			this->m_ManagerList.resize(dwbuf[6]);
+			CKDWORD objlist_size = dwbuf[4], chklist_size = dwbuf[5], mgrlist_size = dwbuf[6];
 			bufpos = 7u;
 
 			if (this->m_DataDwSize != 0) {
-				this->m_pData = new CKDWORD[this->m_DataDwSize];
-				std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				if (borrow) {
+					this->m_pData = const_cast<CKDWORD*>(dwbuf + bufpos);
+				} else {
+					this->m_pData = new CKDWORD[this->m_DataDwSize];
+					this->m_DataDwCapacity = this->m_DataDwSize;
+					std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				}
 				bufpos += this->m_DataDwSize;
 			}
-			if (!this->m_ObjectList.empty()) {
-				std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
-				bufpos += this->m_ObjectList.size();
-			}
-			if (!this->m_ChunkList.empty()) {
-				std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
-				bufpos += this->m_ChunkList.size();
-			}
-			if (!this->m_ManagerList.empty()) {
-				std::memcpy(this->m_ManagerList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ManagerList.size());
-				bufpos += this->m_ManagerList.size();
+			if (!borrow) {
+				this->m_ObjectList.resize(objlist_size);
+				this->m_ChunkList.resize(chklist_size);
+				this->m_ManagerList.resize(mgrlist_size);
+				if (!this->m_ObjectList.empty()) {
+					std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
+					bufpos += this->m_ObjectList.size();
+				}
+				if (!this->m_ChunkList.empty()) {
+					std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
+					bufpos += this->m_ChunkList.size();
+				}
+				if (!this->m_ManagerList.empty()) {
+					std::memcpy(this->m_ManagerList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ManagerList.size());
+					bufpos += this->m_ManagerList.size();
+				}
 			}
 
 			// no bind file
@@ -416,33 +583,39 @@ namespace LibCmo::CK2 {
 			bufpos = 2u;
 
 			if (this->m_DataDwSize != 0) {
-				this->m_pData = new CKDWORD[this->m_DataDwSize];
-				std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				if (borrow) {
+					this->m_pData = const_cast<CKDWORD*>(dwbuf + bufpos);
+				} else {
+					this->m_pData = new CKDWORD[this->m_DataDwSize];
+					this->m_DataDwCapacity = this->m_DataDwSize;
+					std::memcpy(this->m_pData, dwbuf + bufpos, sizeof(CKDWORD) * this->m_DataDwSize);
+				}
 				bufpos += this->m_DataDwSize;
 			}
 			if (!yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_FILE)) {
 				// forced no bind file
 				this->m_BindFile = nullptr;
 			}
-			if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_IDS)) {
-				this->m_ObjectList.resize(dwbuf[bufpos]);
-				bufpos += 1u;
-				std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
-				bufpos += this->m_ObjectList.size();
-			}
-			if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_CHN)) {
-				this->m_ChunkList.resize(dwbuf[bufpos]);
-				bufpos += 1u;
-				std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
-				bufpos += this->m_ChunkList.size();
+			if (!borrow) {
+				if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_IDS)) {
+					this->m_ObjectList.resize(dwbuf[bufpos]);
+					bufpos += 1u;
+					std::memcpy(this->m_ObjectList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ObjectList.size());
+					bufpos += this->m_ObjectList.size();
+				}
+				if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_CHN)) {
+					this->m_ChunkList.resize(dwbuf[bufpos]);
+					bufpos += 1u;
+					std::memcpy(this->m_ChunkList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ChunkList.size());
+					bufpos += this->m_ChunkList.size();
+				}
+				if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_MAN)) {
+					this->m_ManagerList.resize(dwbuf[bufpos]);
+					bufpos += 1u;
+					std::memcpy(this->m_ManagerList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ManagerList.size());
+					bufpos += this->m_ManagerList.size();
+				}
 			}
-			if (yycc::cenum::has(options, CK_STATECHUNK_CHUNKOPTIONS::CHNK_OPTION_MAN)) {
-				this->m_ManagerList.resize(dwbuf[bufpos]);
-				bufpos += 1u;
-				std::memcpy(this->m_ManagerList.data(), dwbuf + bufpos, sizeof(CKDWORD) * this->m_ManagerList.size());
-				bufpos += this->m_ManagerList.size();
-			}
-
 
 		} else {
 			// too new. can not read, skip
@@ -453,6 +626,9 @@ namespace LibCmo::CK2 {
 	}
 
 	CKDWORD CKStateChunk::ConvertToBuffer(void* buf) {
+		// entry lists are required.
+		this->DetachBorrowedBuffer();
+
 		// calc size and setup options first
 		// size = buffer + buffer_size + header
 		CKDWORD size = (m_DataDwSize * CKSizeof(CKDWORD)) + CKSizeof(CKDWORD) + CKSizeof(CKDWORD);
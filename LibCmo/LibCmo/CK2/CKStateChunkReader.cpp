@@ -1,9 +1,15 @@
 #include "CKStateChunk.hpp"
 #include "CKFile.hpp"
 #include "CKContext.hpp"
+#include <algorithm>
+#include <atomic>
 
 namespace LibCmo::CK2 {
 
+	static std::atomic<CKQWORD> g_SeekCount(0u);
+	static std::atomic<CKQWORD> g_IndexBuildCount(0u);
+	static std::atomic<CKQWORD> g_IndexedIdentifierCount(0u);
+
 	void CKStateChunk::StartRead() {
 		if (this->m_Parser.m_Status != CKStateChunkStatus::IDLE) return;
 
@@ -11,6 +17,10 @@ namespace LibCmo::CK2 {
 		this->m_Parser.m_DataSize = this->m_DataDwSize;
 		this->m_Parser.m_PrevIdentifierPos = 0u;
 		this->m_Parser.m_Status = CKStateChunkStatus::READ;
+
+		// identifier index will be built when seeking first time.
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = false;
 	}
 
 	void CKStateChunk::StopRead() {
@@ -20,6 +30,9 @@ namespace LibCmo::CK2 {
 		this->m_Parser.m_DataSize = this->m_DataDwSize;
 		this->m_Parser.m_PrevIdentifierPos = 0u;
 		this->m_Parser.m_Status = CKStateChunkStatus::IDLE;
+
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = false;
 	}
 
 	/* ========== Identifier Functions ==========*/
@@ -31,17 +44,23 @@ namespace LibCmo::CK2 {
 
 	bool CKStateChunk::SeekIdentifierDwordAndReturnSize(CKDWORD identifier, CKDWORD* out_size) {
 		if (this->m_Parser.m_Status != CKStateChunkStatus::READ) return false;
+		g_SeekCount.fetch_add(1u, std::memory_order_relaxed);
 
-		CKDWORD pos = 0u;
 		if (this->m_DataDwSize < 2u) return false;	// impossible to have a identifier
 
-		// search identifier
-		while (this->m_pData[pos] != identifier) {
-			pos = this->m_pData[pos + 1];
-			if (pos == 0u) return false;	// got tail. no more identifier
-			if (pos + 1 >= this->m_DataDwSize) return false;	// out of buffer
+		// build index if it is the first seeking
+		if (!this->m_IsIdentifierIndexBuilt) {
+			this->BuildIdentifierIndex();
 		}
 
+		// search identifier in index.
+		// index is stable sorted by identifier, so lower bound is the first identifier in linked list.
+		auto finder = std::lower_bound(this->m_IdentifierIndex.begin(), this->m_IdentifierIndex.end(), identifier,
+			[](const IdentifierIndex_t& item, CKDWORD value) -> bool { return item.m_Identifier < value; }
+		);
+		if (finder == this->m_IdentifierIndex.end() || finder->m_Identifier != identifier) return false;
+		CKDWORD pos = finder->m_Pos;
+
 		// got identifier
 		this->m_Parser.m_PrevIdentifierPos = pos;
 		this->m_Parser.m_CurrentPos = pos + 2;
@@ -56,6 +75,46 @@ namespace LibCmo::CK2 {
 		return true;
 	}
 
+	void CKStateChunk::BuildIdentifierIndex() {
+		this->m_IdentifierIndex.clear();
+		this->m_IsIdentifierIndexBuilt = true;
+		g_IndexBuildCount.fetch_add(1u, std::memory_order_relaxed);
+		if (this->m_DataDwSize < 2u) return;	// impossible to have a identifier
+
+		// walk identifier linked list
+		CKDWORD pos = 0u;
+		while (true) {
+			this->m_IdentifierIndex.emplace_back(IdentifierIndex_t { this->m_pData[pos], pos });
+
+			CKDWORD nextpos = this->m_pData[pos + 1];
+			if (nextpos == 0u) break;	// got tail. no more identifier
+			if (nextpos + 1 >= this->m_DataDwSize) break;	// out of buffer
+			if (nextpos <= pos) break;	// broken link. identifier must be placed sequentially
+			pos = nextpos;
+		}
+
+		// sort it for binary search.
+		// use stable sort to make sure the first identifier in linked list is picked when having duplicated identifiers.
+		std::stable_sort(this->m_IdentifierIndex.begin(), this->m_IdentifierIndex.end(),
+			[](const IdentifierIndex_t& lhs, const IdentifierIndex_t& rhs) -> bool { return lhs.m_Identifier < rhs.m_Identifier; }
+		);
+		g_IndexedIdentifierCount.fetch_add(this->m_IdentifierIndex.size(), std::memory_order_relaxed);
+	}
+
+	CKStateChunk::SeekStatistics_t CKStateChunk::GetSeekStatistics() {
+		return SeekStatistics_t {
+			.m_SeekCount = g_SeekCount.load(std::memory_order_relaxed),
+			.m_IndexBuildCount = g_IndexBuildCount.load(std::memory_order_relaxed),
+			.m_IndexedIdentifierCount = g_IndexedIdentifierCount.load(std::memory_order_relaxed),
+		};
+	}
+
+	void CKStateChunk::ResetSeekStatistics() {
+		g_SeekCount.store(0u, std::memory_order_relaxed);
+		g_IndexBuildCount.store(0u, std::memory_order_relaxed);
+		g_IndexedIdentifierCount.store(0u, std::memory_order_relaxed);
+	}
+
 	bool CKStateChunk::LockReadBuffer(const void** ppData, CKDWORD size_in_byte) {
 		// check self status
 		if (this->m_Parser.m_Status != CKStateChunkStatus::READ) return false;
@@ -9,10 +9,7 @@ namespace LibCmo::CK2 {
 		if (this->m_Parser.m_Status != CKStateChunkStatus::IDLE) return;
 
 		// delete all current buffer
-		if (this->m_pData != nullptr) {
-			delete[] this->m_pData;
-			this->m_pData = nullptr;
-		}
+		this->FreeBuffer();
 		this->m_DataDwSize = 0u;
 
 		// reset parser
@@ -37,8 +34,21 @@ namespace LibCmo::CK2 {
 
 		// update buffer size
 		this->m_DataDwSize = this->m_Parser.m_CurrentPos;
-		// shrink it
-		ResizeBuffer(this->m_DataDwSize);
+		// shrink it.
+		if (this->m_DataDwSize == 0u) {
+			ResizeBuffer(0u);
+		} else if (this->m_IsPooledData) {
+			// copy data into a buffer with exact size and give pooled buffer back immediately,
+			// so that the chunks written after this one can reuse it,
+			// instead of keeping all pooled buffers until these chunks are freed.
+			CKDWORD* newbuf = new CKDWORD[this->m_DataDwSize];
+			std::memcpy(newbuf, this->m_pData, sizeof(CKDWORD) * this->m_DataDwSize);
+			this->FreeBuffer();
+			this->m_pData = newbuf;
+			this->m_DataDwCapacity = this->m_DataDwSize;
+		} else if (this->m_DataDwCapacity != this->m_DataDwSize) {
+			ResizeBuffer(this->m_DataDwSize);
+		}
 
 		// shrink 3 vector also
 		this->m_ObjectList.shrink_to_fit();
@@ -383,6 +383,7 @@ namespace LibCmo::CK2 {
 	class CKObjectDeclaration;
 	//class CKContext;
 	class CKBitmapProperties;
+	class CKBitmapData;
 	class CKFileExtension;
 	class CKVertexBuffer;
 
@@ -413,6 +414,7 @@ namespace LibCmo::CK2 {
 	// Important classes (rewritten hugely)
 	class CKContext;
 	class CKStateChunk;
+	class CKStateChunkBufferPool;
 	class CKFileReader;
 	class CKFileWriter;
 	class CKFileVisitor;
@@ -2,14 +2,94 @@
 #include "../CKContext.hpp"
 #include "../ObjImpls/CKObject.hpp"
 #include <yycc/cenum.hpp>
+#include <algorithm>
+#include <cctype>
+#include <new>
 
 namespace LibCmo::CK2::MgrImpls {
 
+	/**
+	 * @brief Get the key of given name used by case-insensitive name index.
+	 * @param[in] name The name. nullptr is not allowed.
+	 * @return The lower case name. It is folded in the same way as CKStrEqualI().
+	*/
+	static XContainer::XString InternalFoldName(CKSTRING name) {
+		XContainer::XString folded(name);
+		for (auto& c : folded) {
+			c = static_cast<char8_t>(std::tolower(c));
+		}
+		return folded;
+	}
+
+#pragma region CKObjectSlabAllocator
+
+	CKObjectSlabAllocator::CKObjectSlabAllocator(size_t obj_size, size_t obj_align) :
+		m_ObjectSize(0), m_ObjectAlign(obj_align), m_ObjectsPerSlab(0),
+		m_Slabs(), m_LastSlabUsed(0), m_FreeList(nullptr) {
+		// every slot should be able to hold the free list pointer.
+		if (m_ObjectAlign < alignof(void*)) m_ObjectAlign = alignof(void*);
+		m_ObjectSize = std::max(obj_size, sizeof(void*));
+		m_ObjectSize = (m_ObjectSize + m_ObjectAlign - 1u) & ~(m_ObjectAlign - 1u);
+		m_ObjectsPerSlab = std::max(c_SlabSize / m_ObjectSize, static_cast<size_t>(1u));
+	}
+
+	CKObjectSlabAllocator::~CKObjectSlabAllocator() {
+		this->Clear();
+	}
+
+	void* CKObjectSlabAllocator::Allocate() {
+		// pick freed slot first
+		if (m_FreeList != nullptr) {
+			void* ptr = m_FreeList;
+			m_FreeList = *static_cast<void**>(ptr);
+			return ptr;
+		}
+
+		// allocate new slab if the last one is full
+		if (m_Slabs.empty() || m_LastSlabUsed >= m_ObjectsPerSlab) {
+			m_Slabs.emplace_back(::operator new(m_ObjectSize * m_ObjectsPerSlab, std::align_val_t(m_ObjectAlign)));
+			m_LastSlabUsed = 0u;
+		}
+
+		// use the next slot of last slab
+		void* ptr = static_cast<char*>(m_Slabs.back()) + m_ObjectSize * m_LastSlabUsed;
+		++m_LastSlabUsed;
+		return ptr;
+	}
+
+	void CKObjectSlabAllocator::Free(void* ptr) {
+		if (ptr == nullptr) return;
+		*static_cast<void**>(ptr) = m_FreeList;
+		m_FreeList = ptr;
+	}
+
+	void CKObjectSlabAllocator::Clear() {
+		for (auto& slab : m_Slabs) {
+			::operator delete(slab, std::align_val_t(m_ObjectAlign));
+		}
+		m_Slabs.clear();
+		m_LastSlabUsed = 0u;
+		m_FreeList = nullptr;
+	}
+
+	size_t CKObjectSlabAllocator::GetObjectSize() const {
+		return m_ObjectSize;
+	}
+
+	size_t CKObjectSlabAllocator::GetObjectAlign() const {
+		return m_ObjectAlign;
+	}
+
+#pragma endregion
+
 	CKObjectManager::CKObjectManager(CKContext* ctx) :
 		CKBaseManager(ctx, OBJECT_MANAGER_GUID, u8"Object Manager"),
 		m_ObjectsList(), m_ReturnedObjectOffsets(), m_ObjectCount(0),
+		m_NameIndex(), m_NameIndexI(), m_NameIndexPosition(), m_NameIndexIPosition(),
 		m_GroupGlobalIndex(), m_SceneGlobalIndex(),
-		m_ObjectsListByClass(CKGetClassCount()) {}
+		m_ObjectsListByClass(CKGetClassCount()), m_ObjectsListByClassIndex(),
+		m_ObjectsOffsetByPointer(), m_ObjectsGeneration(),
+		m_ObjectsAllocator(CKGetClassCount()) {}
 
 	CKObjectManager::~CKObjectManager() {
 		DestroyAllObjects();
@@ -29,7 +109,14 @@ namespace LibCmo::CK2::MgrImpls {
 		if (this->m_ReturnedObjectOffsets.empty()) {
 			// create new CK_ID.
 			decided_off = static_cast<CKDWORD>(m_ObjectsList.size());
+			// check whether CK_ID is running out
+			if (decided_off + OBJECT_ID_OFFSET > OBJECT_ID_SLOT_MASK)
+				throw RuntimeException("Too many objects. CK_ID is running out.");
 			m_ObjectsList.resize(decided_off + 1);
+			m_ObjectsListByClassIndex.resize(decided_off + 1);
+			m_NameIndexPosition.resize(decided_off + 1);
+			m_NameIndexIPosition.resize(decided_off + 1);
+			m_ObjectsGeneration.resize(decided_off + 1, 0u);
 		} else {
 			// use returned CK_ID.
 			decided_off = m_ReturnedObjectOffsets.back();
@@ -41,21 +128,34 @@ namespace LibCmo::CK2::MgrImpls {
 
 		// put into slot and inc count
 		m_ObjectsList[decided_off] = obj;
+		m_ObjectsOffsetByPointer.emplace(obj, decided_off);
 		++m_ObjectCount;
 
-		// add into classid indexed object list
-		m_ObjectsListByClass[static_cast<size_t>(cls)].push_back(Offset2Id(decided_off));
+		// add into classid indexed object list and record its position
+		auto& clsList = m_ObjectsListByClass[static_cast<size_t>(cls)];
+		m_ObjectsListByClassIndex[decided_off] = static_cast<CKDWORD>(clsList.size());
+		clsList.emplace_back(Offset2Id(decided_off));
+		// add into name index
+		InternalAddName(Offset2Id(decided_off), obj->GetName());
 
 		// set out variable
 		return obj;
 	}
 
 	ObjImpls::CKObject* CKObjectManager::GetObject(CK_ID id) {
-		CKDWORD off = Id2Offset(id);
-		if (off >= m_ObjectsList.size()) return nullptr;
+		CKDWORD off;
+		if (!InternalResolveId(id, off)) return nullptr;
 		return m_ObjectsList[off];
 	}
 
+	bool CKObjectManager::InternalResolveId(CK_ID id, CKDWORD& off) {
+		off = Id2Offset(id);
+		if (off >= m_ObjectsList.size()) return false;
+		// stale id has different generation with its slot.
+		if (Id2Generation(id) != m_ObjectsGeneration[off]) return false;
+		return m_ObjectsList[off] != nullptr;
+	}
+
 	CKDWORD CKObjectManager::GetObjectCount() {
 		return m_ObjectCount;
 	}
@@ -80,31 +180,30 @@ namespace LibCmo::CK2::MgrImpls {
 		XContainer::XObjectArray validObjIds;
 		XContainer::XBitArray cids;
 		for (CKDWORD i = 0; i < count; ++i) {
-			CKDWORD off = Id2Offset(ids[i]);
-			if (off >= m_ObjectsList.size()) continue;
+			CKDWORD off;
+			if (!InternalResolveId(ids[i], off)) continue;
 			ObjImpls::CKObject* obj = m_ObjectsList[off];
-			if (obj == nullptr) continue;
 
-			// set to be deleted
+			// skip duplicated id
 			CK_OBJECT_FLAGS objflag = obj->GetObjectFlags();
+			if (yycc::cenum::has(objflag, CK_OBJECT_FLAGS::CK_OBJECT_TOBEDELETED)) continue;
+
+			// set to be deleted
 			yycc::cenum::add(objflag, CK_OBJECT_FLAGS::CK_OBJECT_TOBEDELETED);
 			obj->SetObjectFlags(objflag);
 
 			// collect class id
 			XContainer::NSXBitArray::Set(cids, static_cast<CKDWORD>(obj->GetClassID()));
 
+			// remove it from m_ObjectListByClass and name index,
+			// so that it is invisible for other objects during deletion.
+			InternalRemoveFromClassList(off, obj->GetClassID());
+			InternalRemoveName(ids[i], obj->GetName());
+
 			// add into list
 			validObjIds.emplace_back(ids[i]);
 		}
 
-		// then remove deleted object from m_ObjectListByClass
-		// because we have set to be deleted flag.
-		for (size_t i = 0; i < m_ObjectsListByClass.size(); ++i) {
-			if (!XContainer::NSXBitArray::IsSet(cids, static_cast<CKDWORD>(i))) 
-				continue;
-			XContainer::NSXObjectArray::PreDeletedCheck(m_ObjectsListByClass[i], m_Context);
-		}
-
 		// use collected cid to get all class ids which need receive notify
 		// and use m_ObjectListByClass to notify them
 		XContainer::XBitArray notifyCids = CKGetAllNotifyClassID(cids);
@@ -126,13 +225,15 @@ namespace LibCmo::CK2::MgrImpls {
 			CKDWORD off = Id2Offset(objid);
 			ObjImpls::CKObject* obj = m_ObjectsList[off];
 			
-			// free it
+			// remove from pointer index, then free it
+			m_ObjectsOffsetByPointer.erase(obj);
 			InternalDestroy(obj);
 			
-			// return its allocated id.
-			// and dec count
+			// make all held id of this slot stale, then return its allocated id
+			// if its generation is not exhausted. and dec count
 			m_ObjectsList[off] = nullptr;
-			m_ReturnedObjectOffsets.emplace_back(off);
+			if (++m_ObjectsGeneration[off] < OBJECT_ID_MAX_GENERATION)
+				m_ReturnedObjectOffsets.emplace_back(off);
 			--m_ObjectCount;
 		}
 
@@ -156,10 +257,19 @@ namespace LibCmo::CK2::MgrImpls {
 				InternalDestroy(ptr);
 			}
 		}
-		// restore returned object list
+		// make all slots returned but keep their generation,
+		// so that the CK_ID held before clearing is still stale.
+		// returned in reverse order so that smaller CK_ID will be used first.
 		m_ReturnedObjectOffsets.clear();
+		for (size_t i = m_ObjectsList.size(); i > 0; --i) {
+			CKDWORD off = static_cast<CKDWORD>(i - 1);
+			if (m_ObjectsList[off] != nullptr) ++m_ObjectsGeneration[off];
+			if (m_ObjectsGeneration[off] < OBJECT_ID_MAX_GENERATION)
+				m_ReturnedObjectOffsets.emplace_back(off);
+		}
 		// empty object list
-		m_ObjectsList.clear();
+		std::fill(m_ObjectsList.begin(), m_ObjectsList.end(), nullptr);
+		m_ObjectsOffsetByPointer.clear();
 		// reset count
 		m_ObjectCount = 0;
 
@@ -167,6 +277,14 @@ namespace LibCmo::CK2::MgrImpls {
 		for (auto& ls : m_ObjectsListByClass) {
 			ls.clear();
 		}
+		// clear name index
+		m_NameIndex.clear();
+		m_NameIndexI.clear();
+
+		// all objects are destructed. free all slabs at once.
+		for (auto& allocator : m_ObjectsAllocator) {
+			if (allocator != nullptr) allocator->Clear();
+		}
 
 		// clear group and scene global index at the same time
 		m_SceneGlobalIndex.clear();
@@ -174,8 +292,49 @@ namespace LibCmo::CK2::MgrImpls {
 	}
 
 	XContainer::XObjectPointerArray CKObjectManager::GetObjectByNameAndClass(CKSTRING name, CK_CLASSID cid, bool derived) {
+		return InternalGetObjectByNameAndClass(name, cid, derived, true);
+	}
+
+	XContainer::XObjectPointerArray CKObjectManager::GetObjectByNameAndClassI(CKSTRING name, CK_CLASSID cid, bool derived) {
+		return InternalGetObjectByNameAndClass(name, cid, derived, false);
+	}
+
+	XContainer::XObjectPointerArray CKObjectManager::InternalGetObjectByNameAndClass(CKSTRING name, CK_CLASSID cid, bool derived, bool case_sensitive) {
 		XContainer::XObjectPointerArray result;
 
+		// if name is specified, use name index directly.
+		if (name != nullptr) {
+			const XContainer::XObjectArray* candidates = nullptr;
+			if (case_sensitive) {
+				// the name which is not interned definitely is not used by any object.
+				auto finder = m_NameIndex.find(m_Context->FindInternedName(name));
+				if (finder == m_NameIndex.end()) return result;
+				candidates = &finder->second;
+			} else {
+				auto finder = m_NameIndexI.find(InternalFoldName(name));
+				if (finder == m_NameIndexI.end()) return result;
+				candidates = &finder->second;
+			}
+
+			// check class id of each object
+			for (const auto& objid : *candidates) {
+				ObjImpls::CKObject* obj = m_ObjectsList[Id2Offset(objid)];
+				CK_CLASSID objcid = obj->GetClassID();
+				if (derived) {
+					if (!CKIsChildClassOf(objcid, cid)) continue;
+				} else {
+					if (objcid != cid) continue;
+				}
+				result.emplace_back(obj);
+			}
+
+			// keep the result ordered by class id like iterating all classes.
+			std::stable_sort(result.begin(), result.end(), [](ObjImpls::CKObject* lhs, ObjImpls::CKObject* rhs) -> bool {
+				return static_cast<CKDWORD>(lhs->GetClassID()) < static_cast<CKDWORD>(rhs->GetClassID());
+			});
+			return result;
+		}
+
 		for (size_t i = 0; i < m_ObjectsListByClass.size(); ++i) {
 			// check class id first
 			if (derived) {
@@ -184,41 +343,104 @@ namespace LibCmo::CK2::MgrImpls {
 				if (static_cast<CK_CLASSID>(i) != cid) continue;
 			}
 
-			// iterate all sub object and check name
+			// iterate all sub object and add them
 			for (const auto& objid : m_ObjectsListByClass[i]) {
-				ObjImpls::CKObject* obj = m_ObjectsList[Id2Offset(objid)];
-
-				if (name == nullptr) {
-					// directly add
-					result.emplace_back(obj);
-				} else {
-					// check name
-					if (CKStrEqual(name, obj->GetName())) {
-						result.emplace_back(obj);
-					}
-				}
+				result.emplace_back(m_ObjectsList[Id2Offset(objid)]);
 			}
 		}
 
 		return result;
 	}
 
+	void* CKObjectManager::AllocateObjectMemory(CK_CLASSID cid, size_t size, size_t align) {
+		size_t idx = static_cast<size_t>(cid);
+		if (idx >= m_ObjectsAllocator.size()) throw LogicException("Invalid CK_CLASSID");
+
+		// create allocator for this class if it is not existing.
+		auto& allocator = m_ObjectsAllocator[idx];
+		if (allocator == nullptr) {
+			allocator = std::make_unique<CKObjectSlabAllocator>(size, align);
+		}
+		return allocator->Allocate();
+	}
+
+	void CKObjectManager::FreeObjectMemory(CK_CLASSID cid, void* ptr) {
+		size_t idx = static_cast<size_t>(cid);
+		if (idx >= m_ObjectsAllocator.size() || m_ObjectsAllocator[idx] == nullptr)
+			throw LogicException("Given memory is not allocated by AllocateObjectMemory().");
+		m_ObjectsAllocator[idx]->Free(ptr);
+	}
+
+	void CKObjectManager::NotifyObjectRenamed(ObjImpls::CKObject* obj, CKSTRING old_name) {
+		// ignore the object not managed by us
+		if (obj == nullptr || GetObject(obj->GetID()) != obj) return;
+		// the object being deleted has been removed from name index
+		if (obj->IsToBeDeleted()) return;
+
+		InternalRemoveName(obj->GetID(), old_name);
+		InternalAddName(obj->GetID(), obj->GetName());
+	}
+
+	void CKObjectManager::InternalRemoveFromClassList(CKDWORD off, CK_CLASSID cid) {
+		auto& clsList = m_ObjectsListByClass[static_cast<size_t>(cid)];
+		CKDWORD pos = m_ObjectsListByClassIndex[off];
+
+		// move the last one into removed position and update its back index
+		CK_ID lastId = clsList.back();
+		clsList[pos] = lastId;
+		m_ObjectsListByClassIndex[Id2Offset(lastId)] = pos;
+		clsList.pop_back();
+	}
+
+	void CKObjectManager::InternalAddName(CK_ID id, CKSTRING name) {
+		if (name == nullptr) return;
+		CKDWORD off = Id2Offset(id);
+
+		// add into list and record its position
+		auto& ids = m_NameIndex[name];
+		m_NameIndexPosition[off] = static_cast<CKDWORD>(ids.size());
+		ids.emplace_back(id);
+		auto& idsI = m_NameIndexI[InternalFoldName(name)];
+		m_NameIndexIPosition[off] = static_cast<CKDWORD>(idsI.size());
+		idsI.emplace_back(id);
+	}
+
+	void CKObjectManager::InternalRemoveName(CK_ID id, CKSTRING name) {
+		if (name == nullptr) return;
+
+		auto remover = [this, id](auto& index, const auto& key, XContainer::XArray<CKDWORD>& positions) -> void {
+			auto finder = index.find(key);
+			if (finder == index.end()) return;
+			auto& ids = finder->second;
+			// check recorded position, because given object may not be in index.
+			CKDWORD pos = positions[Id2Offset(id)];
+			if (pos >= ids.size() || ids[pos] != id) return;
+
+			// move the last one into removed position and update its position
+			CK_ID lastId = ids.back();
+			ids[pos] = lastId;
+			positions[Id2Offset(lastId)] = pos;
+			ids.pop_back();
+			if (ids.empty()) index.erase(finder);
+		};
+		remover(m_NameIndex, name, m_NameIndexPosition);
+		remover(m_NameIndexI, InternalFoldName(name), m_NameIndexIPosition);
+	}
+
 #pragma region Object Check
 
 	bool CKObjectManager::IsObjectSafe(CK_ID objid) {
-		CKDWORD off = Id2Offset(objid);
-		if (off >= m_ObjectsList.size()) return false;
-		return m_ObjectsList[off] != nullptr;
+		CKDWORD off;
+		return InternalResolveId(objid, off);
 	}
 
 	bool CKObjectManager::IsObjectPointerSafe(const ObjImpls::CKObject* objptr) {
 		if (objptr == nullptr) return false;
 
-		// iterate all object list to check
-		for (const auto& ptr : m_ObjectsList) {
-			if (ptr == objptr) return true;
-		}
-		return false;
+		// look up pointer index and cross check with object list
+		auto finder = m_ObjectsOffsetByPointer.find(objptr);
+		if (finder == m_ObjectsOffsetByPointer.end()) return false;
+		return m_ObjectsList[finder->second] == objptr;
 	}
 	
 #pragma endregion
@@ -2,10 +2,70 @@
 
 #include "../../VTInternal.hpp"
 #include "CKBaseManager.hpp"
-#include <deque>
 
 namespace LibCmo::CK2::MgrImpls {
 
+	/**
+	 * @brief The slab allocator providing memory for CKObject instances of one class.
+	 * @details
+	 * Objects are allocated in large slabs, so that objects of the same class are placed closely.
+	 * Freed memory is put in a free list and reused by next allocation.
+	 * @remarks
+	 * \li This allocator only manage memory. Constructing and destructing object is caller's work.
+	 * \li This allocator is not thread-safe.
+	*/
+	class CKObjectSlabAllocator {
+	public:
+		/**
+		 * @brief Create allocator for objects with given size and alignment.
+		 * @param[in] obj_size The size of object.
+		 * @param[in] obj_align The alignment of object. It must be the power of 2.
+		*/
+		CKObjectSlabAllocator(size_t obj_size, size_t obj_align);
+		~CKObjectSlabAllocator();
+		YYCC_DELETE_COPY_MOVE(CKObjectSlabAllocator)
+
+		/**
+		 * @brief Allocate memory for one object.
+		 * @return The uninitialized memory for one object.
+		*/
+		void* Allocate();
+		/**
+		 * @brief Give memory of one object back.
+		 * @param[in] ptr The memory returned by Allocate(). The object located in it must be destructed. nullptr is allowed.
+		*/
+		void Free(void* ptr);
+		/**
+		 * @brief Free all slabs at once.
+		 * @remarks All objects allocated by this allocator must be destructed before calling this.
+		*/
+		void Clear();
+
+		size_t GetObjectSize() const;
+		size_t GetObjectAlign() const;
+
+	private:
+		/**
+		 * @brief The minimum byte size of one slab.
+		*/
+		static constexpr size_t c_SlabSize = 64u * 1024u;
+
+		size_t m_ObjectSize; /**< The real size of slot which is rounded up by alignment. */
+		size_t m_ObjectAlign;
+		size_t m_ObjectsPerSlab;
+		XContainer::XArray<void*> m_Slabs;
+		/**
+		 * @brief The count of used slots in the last slab.
+		 * @details Slots after this position are never used, so they are not in free list.
+		*/
+		size_t m_LastSlabUsed;
+		/**
+		 * @brief The head of intrusive free list.
+		 * @details The first bytes of each free slot store the pointer to next free slot.
+		*/
+		void* m_FreeList;
+	};
+
 	class CKObjectManager : public CKBaseManager {
 	public:
 		CKObjectManager(CKContext* ctx);
@@ -37,6 +97,33 @@ namespace LibCmo::CK2::MgrImpls {
 		CKDWORD GetObjectCount();
 		void DestroyObjects(CK_ID* ids, CKDWORD count);
 		void DestroyAllObjects();
+		/**
+		 * @brief Get the CK_ID which should be written in file for given object id.
+		 * @param[in] id The CK_ID of object.
+		 * @return The CK_ID without generation part.
+		 * @remarks
+		 * \li The generation part of CK_ID only make sense in current context,
+		 * and it will make saved CK_ID too large for Virtools. So it must be removed when saving.
+		 * \li The CK_ID of alive objects are still unique after removing generation part.
+		*/
+		static CK_ID GetSavedObjectId(CK_ID id) { return static_cast<CK_ID>(id & OBJECT_ID_SLOT_MASK); }
+
+		/**
+		 * @brief Allocate memory for one object of given class.
+		 * @param[in] cid The class id of object.
+		 * @param[in] size The size of object. All objects of the same class must have the same size.
+		 * @param[in] align The alignment of object.
+		 * @return The uninitialized memory for object.
+		 * @remarks This is used by the CKClassCreationFct registered in CKStartUp().
+		 * Objects of the same class are allocated from the same slab allocator.
+		*/
+		void* AllocateObjectMemory(CK_CLASSID cid, size_t size, size_t align);
+		/**
+		 * @brief Give the memory allocated by AllocateObjectMemory() back.
+		 * @param[in] cid The class id of object.
+		 * @param[in] ptr The memory of destructed object.
+		*/
+		void FreeObjectMemory(CK_CLASSID cid, void* ptr);
 
 		// ========== Objects Access ==========
 
@@ -49,6 +136,23 @@ namespace LibCmo::CK2::MgrImpls {
 		*/
 		XContainer::XObjectPointerArray GetObjectByNameAndClass(
 			CKSTRING name, CK_CLASSID cid, bool derived);
+		/**
+		 * @brief Case-insensitive version of GetObjectByNameAndClass().
+		 * @param name nullptr if no requirement.
+		 * @param cid the class id
+		 * @param derived whether considering derived class
+		 * @return the result pointer list.
+		 * @remarks The name is compared in the same way as CKStrEqualI().
+		*/
+		XContainer::XObjectPointerArray GetObjectByNameAndClassI(
+			CKSTRING name, CK_CLASSID cid, bool derived);
+		/**
+		 * @brief Update name index after the name of object is changed.
+		 * @param[in] obj The renamed object. The object not managed by this manager will be ignored.
+		 * @param[in] old_name The name of object before renaming. nullptr if it has no name.
+		 * @remarks Called by CKObject::SetName() automatically.
+		*/
+		void NotifyObjectRenamed(ObjImpls::CKObject* obj, CKSTRING old_name);
 
 		// ========== Object Check ==========
 		bool IsObjectSafe(CK_ID objid);
@@ -68,19 +172,114 @@ namespace LibCmo::CK2::MgrImpls {
 		 * So we add a static offset to every created CK_ID.
 		*/
 		static constexpr CK_ID OBJECT_ID_OFFSET = 61u;
-		CKDWORD Id2Offset(CK_ID id) { return static_cast<CKDWORD>(id - OBJECT_ID_OFFSET); }
-		CK_ID Offset2Id(CKDWORD off) { return static_cast<CK_ID>(off + OBJECT_ID_OFFSET); }
+		/**
+		 * The count of low bits of CK_ID which is used for storing the slot of object.
+		 * The remaining high bits store the generation of slot, except the highest bit.
+		 * The highest bit is kept zero because CKStateChunk use it to mark negative reference.
+		*/
+		static constexpr CKDWORD OBJECT_ID_SLOT_BITS = 24u;
+		static constexpr CK_ID OBJECT_ID_SLOT_MASK = (static_cast<CK_ID>(1) << OBJECT_ID_SLOT_BITS) - 1u;
+		/**
+		 * The maximum generation of slot.
+		 * The slot reaching this generation will be retired and never reused,
+		 * so that a stale CK_ID never resolve to another object.
+		*/
+		static constexpr CKDWORD OBJECT_ID_MAX_GENERATION = 0x7Fu;
+		CKDWORD Id2Offset(CK_ID id) { return static_cast<CKDWORD>((id & OBJECT_ID_SLOT_MASK) - OBJECT_ID_OFFSET); }
+		CKDWORD Id2Generation(CK_ID id) { return static_cast<CKDWORD>(id >> OBJECT_ID_SLOT_BITS); }
+		CK_ID Offset2Id(CKDWORD off) { return static_cast<CK_ID>((m_ObjectsGeneration[off] << OBJECT_ID_SLOT_BITS) | (off + OBJECT_ID_OFFSET)); }
+		/**
+		 * @brief Get the slot offset of given CK_ID and check whether it is still alive.
+		 * @param[in] id The CK_ID to be checked.
+		 * @param[out] off The offset of object in m_ObjectsList if this function return true.
+		 * @return True if given CK_ID point to an alive object, otherwise false (including stale CK_ID).
+		*/
+		bool InternalResolveId(CK_ID id, CKDWORD& off);
 
 		/**
 		 * @brief The real CKObject destroy worker shared by CKObjectManager::DestroyObject and CKObjectManager::~CKObjectManager
 		 * @param[in] obj The CKObject need to be free.
 		*/
 		void InternalDestroy(ObjImpls::CKObject* obj);
+		/**
+		 * @brief The real worker of GetObjectByNameAndClass() and GetObjectByNameAndClassI().
+		*/
+		XContainer::XObjectPointerArray InternalGetObjectByNameAndClass(
+			CKSTRING name, CK_CLASSID cid, bool derived, bool case_sensitive);
+		/**
+		 * @brief Add object into name index.
+		 * @param[in] id The id of object.
+		 * @param[in] name The interned name of object. nullptr is allowed and will be ignored.
+		*/
+		void InternalAddName(CK_ID id, CKSTRING name);
+		/**
+		 * @brief Remove object from name index.
+		 * @param[in] id The id of object.
+		 * @param[in] name The interned name of object when it was added into index. nullptr is allowed and will be ignored.
+		 * @remarks The last id of list is moved to the position of removed one, like InternalRemoveFromClassList().
+		 * Nothing happens if given object is not in index.
+		*/
+		void InternalRemoveName(CK_ID id, CKSTRING name);
+		/**
+		 * @brief Remove object from its class indexed object list.
+		 * @param[in] off The offset of object in m_ObjectsList.
+		 * @param[in] cid The class id of object.
+		 * @remarks The last id of list is moved to the position of removed one,
+		 * so the order of class indexed object list is not preserved.
+		*/
+		void InternalRemoveFromClassList(CKDWORD off, CK_CLASSID cid);
 
 		CKDWORD m_ObjectCount;
 		XContainer::XObjectPointerArray m_ObjectsList;
-		XContainer::XArray<XContainer::XList<CKDWORD>> m_ObjectsListByClass;
-		std::deque<CKDWORD> m_ReturnedObjectOffsets;
+		/**
+		 * @brief The packed ids of objects grouped by their class id.
+		*/
+		XContainer::XArray<XContainer::XObjectArray> m_ObjectsListByClass;
+		/**
+		 * @brief The position of each object in its class indexed object list.
+		 * @details It has the same size with m_ObjectsList and is indexed by object offset.
+		 * The value of empty slot is meaningless.
+		*/
+		XContainer::XArray<CKDWORD> m_ObjectsListByClassIndex;
+		/**
+		 * @brief The reverse index from object pointer to its offset in m_ObjectsList.
+		 * @details It is used by IsObjectPointerSafe() to validate pointer without dereferencing it.
+		*/
+		XContainer::XHashTable<const ObjImpls::CKObject*, CKDWORD> m_ObjectsOffsetByPointer;
+		XContainer::XArray<CKDWORD> m_ReturnedObjectOffsets;
+		/**
+		 * @brief The current generation of each slot in m_ObjectsList.
+		 * @details It has the same size with m_ObjectsList.
+		 * The generation is increased when the object in slot is destroyed,
+		 * including DestroyAllObjects(), so CK_ID held across CKContext::ClearAll() stays stale.
+		*/
+		XContainer::XArray<CKDWORD> m_ObjectsGeneration;
+		/**
+		 * @brief The slab allocator of each class. Created when the first object of class is created.
+		 * @details All slabs are freed at once in DestroyAllObjects().
+		*/
+		XContainer::XArray<std::unique_ptr<CKObjectSlabAllocator>> m_ObjectsAllocator;
+		/**
+		 * @brief The index from object name to the ids of objects which have this name.
+		 * @details
+		 * The key is the name interned in CKContext, so it is hashed and compared by pointer.
+		 * The object without name is not indexed because it can not be found by name.
+		*/
+		XContainer::XHashTable<CKSTRING, XContainer::XObjectArray> m_NameIndex;
+		/**
+		 * @brief Same as m_NameIndex, but the key is lower case name used by case-insensitive lookup.
+		*/
+		XContainer::XHashTable<XContainer::XString, XContainer::XObjectArray> m_NameIndexI;
+		/**
+		 * @brief The position of each object in its id list of m_NameIndex.
+		 * @details It has the same size with m_ObjectsList and is indexed by object offset.
+		 * The value of the object which is not in name index is meaningless.
+		*/
+		XContainer::XArray<CKDWORD> m_NameIndexPosition;
+		/**
+		 * @brief Same as m_NameIndexPosition, but for m_NameIndexI.
+		*/
+		XContainer::XArray<CKDWORD> m_NameIndexIPosition;
 
 		XContainer::XBitArray m_GroupGlobalIndex;
 		XContainer::XBitArray m_SceneGlobalIndex;
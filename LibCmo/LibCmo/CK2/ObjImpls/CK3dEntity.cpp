@@ -257,6 +257,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CK3dEntity::SetWorldMatrix(const VxMath::VxMatrix& mat) {
+		this->SetDirty(true);
 		m_WorldMatrix = mat;
 	}
 
@@ -265,6 +266,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CK3dEntity::SetEntityFlags(CK_3DENTITY_FLAGS flags) {
+		this->SetDirty(true);
 		m_3dEntityFlags = flags;
 	}
 
@@ -273,6 +275,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CK3dEntity::SetMoveableFlags(VxMath::VX_MOVEABLE_FLAGS flags) {
+		this->SetDirty(true);
 		m_MoveableFlags = flags;
 	}
 
@@ -281,6 +284,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CK3dEntity::SetZOrder(CKDWORD ord) {
+		this->SetDirty(true);
 		m_ZOrder = ord;
 	}
 
@@ -289,11 +293,15 @@ namespace LibCmo::CK2::ObjImpls {
 #pragma region Mesh Oper
 
 	void CK3dEntity::AddPotentialMesh(CKMesh* mesh) {
-		XContainer::NSXObjectPointerArray::AddIfNotHere(m_PotentialMeshes, mesh);
+		if (XContainer::NSXObjectPointerArray::AddIfNotHere(m_PotentialMeshes, mesh)) {
+			this->SetDirty(true);
+		}
 	}
 
 	void CK3dEntity::RemovePotentialMesh(CKMesh* mesh) {
-		std::erase(m_PotentialMeshes, mesh);
+		if (std::erase(m_PotentialMeshes, mesh) != 0) {
+			this->SetDirty(true);
+		}
 	}
 
 	CKDWORD CK3dEntity::GetPotentialMeshCount() const {
@@ -310,6 +318,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CK3dEntity::SetCurrentMesh(CKMesh* mesh) {
+		this->SetDirty(true);
 		m_CurrentMesh = mesh;
 		if (mesh != nullptr) {
 			AddPotentialMesh(mesh);
@@ -84,6 +84,7 @@ SetObjectFlags(obj_flags); \
 		return m_ProjectType;
 	}
 	void CKCamera::SetProjectionType(CK_CAMERA_PROJECTION proj) {
+		this->SetDirty(true);
 		m_ProjectType = proj;
 		REMOVE_UPTODATE_FLAG;
 	}
@@ -92,6 +93,7 @@ SetObjectFlags(obj_flags); \
 		return m_OrthographicZoom;
 	}
 	void CKCamera::SetOrthographicZoom(CKFLOAT zoom) {
+		this->SetDirty(true);
 		m_OrthographicZoom = zoom;
 		REMOVE_UPTODATE_FLAG;
 	}
@@ -106,14 +108,17 @@ SetObjectFlags(obj_flags); \
 		return m_Fov;
 	}
 	void CKCamera::SetFrontPlane(CKFLOAT front) {
+		this->SetDirty(true);
 		m_FrontPlane = front;
 		REMOVE_UPTODATE_FLAG;
 	}
 	void CKCamera::SetBackPlane(CKFLOAT back) {
+		this->SetDirty(true);
 		m_BackPlane = back;
 		REMOVE_UPTODATE_FLAG;
 	}
 	void CKCamera::SetFov(CKFLOAT fov) {
+		this->SetDirty(true);
 		m_Fov = fov;
 		REMOVE_UPTODATE_FLAG;
 	}
@@ -123,6 +128,7 @@ SetObjectFlags(obj_flags); \
 		height = m_Height;
 	}
 	void CKCamera::SetAspectRatio(CKDWORD width, CKDWORD height) {
+		this->SetDirty(true);
 		m_Width = width;
 		m_Height = height;
 		REMOVE_UPTODATE_FLAG;
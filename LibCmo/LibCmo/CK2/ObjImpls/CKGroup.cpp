@@ -101,6 +101,7 @@ namespace LibCmo::CK2::ObjImpls {
 			return CKERROR::CKERR_ALREADYPRESENT;
 		}
 
+		this->SetDirty(true);
 		// set object
 		o->ExplicitSetGroup(m_GroupIndex, true);
 		// set self
@@ -111,6 +112,7 @@ namespace LibCmo::CK2::ObjImpls {
 	CKBeObject* CKGroup::RemoveObject(CKDWORD pos) {
 		// check pos
 		if (pos >= m_ObjectArray.size()) return nullptr;
+		this->SetDirty(true);
 
 		auto it = m_ObjectArray.begin() + pos;
 		CKBeObject* obj = static_cast<CKBeObject*>(*it);
@@ -125,6 +127,7 @@ namespace LibCmo::CK2::ObjImpls {
 		// find first
 		auto finder = std::find(m_ObjectArray.begin(), m_ObjectArray.end(), static_cast<CKObject*>(obj));
 		if (finder != m_ObjectArray.end()) {
+			this->SetDirty(true);
 			// set object
 			static_cast<CKBeObject*>(*finder)->ExplicitSetGroup(m_GroupIndex, false);
 			// remove self
@@ -133,6 +136,8 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKGroup::Clear() {
+		if (m_ObjectArray.empty()) return;
+		this->SetDirty(true);
 		for (auto& beobj : m_ObjectArray) {
 			// set object
 			static_cast<CKBeObject*>(beobj)->ExplicitSetGroup(m_GroupIndex, false);
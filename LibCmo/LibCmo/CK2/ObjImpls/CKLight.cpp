@@ -134,6 +134,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightData.m_Type;
 	}
 	void CKLight::SetType(VxMath::VXLIGHT_TYPE light_type) {
+		this->SetDirty(true);
 		m_LightData.m_Type = light_type;
 	}
 
@@ -141,6 +142,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightData.m_Diffuse;
 	}
 	void CKLight::SetColor(const VxMath::VxColor& c) {
+		this->SetDirty(true);
 		m_LightData.m_Diffuse = c;
 	}
 
@@ -154,12 +156,15 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightData.m_Attenuation2;
 	}
 	void CKLight::SetConstantAttenuation(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_Attenuation0 = value;
 	}
 	void CKLight::SetLinearAttenuation(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_Attenuation1 = value;
 	}
 	void CKLight::SetQuadraticAttenuation(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_Attenuation2 = value;
 	}
 
@@ -167,6 +172,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightData.m_Range;
 	}
 	void CKLight::SetRange(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_Range = value;
 	}
 
@@ -180,12 +186,15 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightData.m_Falloff;
 	}
 	void CKLight::SetHotSpot(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_InnerSpotCone = value;
 	}
 	void CKLight::SetFalloff(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_OuterSpotCone = value;
 	}
 	void CKLight::SetFalloffShape(CKFLOAT value) {
+		this->SetDirty(true);
 		m_LightData.m_Falloff = value;
 	}
 
@@ -193,6 +202,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return yycc::cenum::has(m_LightFlags, LightFlags::Active);
 	}
 	void CKLight::Active(bool active) {
+		this->SetDirty(true);
 		if (active) {
 			yycc::cenum::add(m_LightFlags, LightFlags::Active);
 		} else {
@@ -204,6 +214,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return yycc::cenum::has(m_LightFlags, LightFlags::Specular);
 	}
 	void CKLight::SetSpecularFlag(bool specular) {
+		this->SetDirty(true);
 		if (specular) {
 			yycc::cenum::add(m_LightFlags, LightFlags::Specular);
 		} else {
@@ -225,6 +236,7 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_LightPower;
 	}
 	void CKLight::SetLightPower(CKFLOAT power) {
+		this->SetDirty(true);
 		m_LightPower = power;
 	}
 
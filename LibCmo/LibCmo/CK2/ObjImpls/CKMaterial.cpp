@@ -257,30 +257,35 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_Diffuse;
 	}
 	void CKMaterial::SetDiffuse(const VxMath::VxColor& col) {
+		this->SetDirty(true);
 		m_Diffuse = col;
 	}
 	const VxMath::VxColor& CKMaterial::GetAmbient() const {
 		return m_Ambient;
 	}
 	void CKMaterial::SetAmbient(const VxMath::VxColor& col) {
+		this->SetDirty(true);
 		m_Ambient = col;
 	}
 	const VxMath::VxColor& CKMaterial::GetSpecular() const {
 		return m_Specular;
 	}
 	void CKMaterial::SetSpecular(const VxMath::VxColor& col) {
+		this->SetDirty(true);
 		m_Specular = col;
 	}
 	const VxMath::VxColor& CKMaterial::GetEmissive() const {
 		return m_Emissive;
 	}
 	void CKMaterial::SetEmissive(const VxMath::VxColor& col) {
+		this->SetDirty(true);
 		m_Emissive = col;
 	}
 	CKFLOAT CKMaterial::GetSpecularPower() const {
 		return m_SpecularPower;
 	}
 	void CKMaterial::SetSpecularPower(CKFLOAT val) {
+		this->SetDirty(true);
 		m_SpecularPower = val;
 	}
 
@@ -291,12 +296,14 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 	void CKMaterial::SetTexture(CKTexture* tex, CKDWORD idx) {
 		if (idx >= m_Textures.size()) return;
+		this->SetDirty(true);
 		m_Textures[idx] = tex;
 	}
 	CKDWORD CKMaterial::GetTextureBorderColor() const {
 		return m_TextureBorderColor;
 	}
 	void CKMaterial::SetTextureBorderColor(CKDWORD val) {
+		this->SetDirty(true);
 		m_TextureBorderColor = val;
 	}
 
@@ -305,24 +312,28 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_TextureBlendMode;
 	}
 	void CKMaterial::SetTextureBlendMode(VxMath::VXTEXTURE_BLENDMODE val) {
+		this->SetDirty(true);
 		m_TextureBlendMode = val;
 	}
 	VxMath::VXTEXTURE_FILTERMODE CKMaterial::GetTextureMinMode() const {
 		return m_TextureMinMode;
 	}
 	void CKMaterial::SetTextureMinMode(VxMath::VXTEXTURE_FILTERMODE val) {
+		this->SetDirty(true);
 		m_TextureMinMode = val;
 	}
 	VxMath::VXTEXTURE_FILTERMODE CKMaterial::GetTextureMagMode() const {
 		return m_TextureMagMode;
 	}
 	void CKMaterial::SetTextureMagMode(VxMath::VXTEXTURE_FILTERMODE val) {
+		this->SetDirty(true);
 		m_TextureMagMode = val;
 	}
 	VxMath::VXTEXTURE_ADDRESSMODE CKMaterial::GetTextureAddressMode() const {
 		return m_TextureAddressMode;
 	}
 	void CKMaterial::SetTextureAddressMode(VxMath::VXTEXTURE_ADDRESSMODE val) {
+		this->SetDirty(true);
 		m_TextureAddressMode = val;
 	}
 
@@ -331,24 +342,28 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_SourceBlend;
 	}
 	void CKMaterial::SetSourceBlend(VxMath::VXBLEND_MODE val) {
+		this->SetDirty(true);
 		m_SourceBlend = val;
 	}
 	VxMath::VXBLEND_MODE CKMaterial::GetDestBlend() const {
 		return m_DestBlend;
 	}
 	void CKMaterial::SetDestBlend(VxMath::VXBLEND_MODE val) {
+		this->SetDirty(true);
 		m_DestBlend = val;
 	}
 	VxMath::VXFILL_MODE CKMaterial::GetFillMode() const {
 		return m_FillMode;
 	}
 	void CKMaterial::SetFillMode(VxMath::VXFILL_MODE val) {
+		this->SetDirty(true);
 		m_FillMode = val;
 	}
 	VxMath::VXSHADE_MODE CKMaterial::GetShadeMode() const {
 		return m_ShadeMode;
 	}
 	void CKMaterial::SetShadeMode(VxMath::VXSHADE_MODE val) {
+		this->SetDirty(true);
 		m_ShadeMode = val;
 	}
 
@@ -357,30 +372,35 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_EnableAlphaTest;
 	}
 	void CKMaterial::SetAlphaTestEnabled(bool enabled) {
+		this->SetDirty(true);
 		m_EnableAlphaTest = enabled;
 	}
 	bool CKMaterial::GetAlphaBlendEnabled() const {
 		return m_EnableAlphaBlend;
 	}
 	void CKMaterial::SetAlphaBlendEnabled(bool enabled) {
+		this->SetDirty(true);
 		m_EnableAlphaBlend = enabled;
 	}
 	bool CKMaterial::GetPerspectiveCorrectionEnabled() const {
 		return m_EnablePerspectiveCorrection;
 	}
 	void CKMaterial::SetPerspectiveCorrectionEnabled(bool enabled) {
+		this->SetDirty(true);
 		m_EnablePerspectiveCorrection = enabled;
 	}
 	bool CKMaterial::GetZWriteEnabled() const {
 		return m_EnableZWrite;
 	}
 	void CKMaterial::SetZWriteEnabled(bool enabled) {
+		this->SetDirty(true);
 		m_EnableZWrite = enabled;
 	}
 	bool CKMaterial::GetTwoSidedEnabled() const {
 		return m_EnableTwoSided;
 	}
 	void CKMaterial::SetTwoSidedEnabled(bool enabled) {
+		this->SetDirty(true);
 		m_EnableTwoSided = enabled;
 	}
 
@@ -389,24 +409,28 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_AlphaRef;
 	}
 	void CKMaterial::SetAlphaRef(CKBYTE val) {
+		this->SetDirty(true);
 		m_AlphaRef = val;
 	}
 	VxMath::VXCMPFUNC CKMaterial::GetAlphaFunc() const {
 		return m_AlphaFunc;
 	}
 	void CKMaterial::SetAlphaFunc(VxMath::VXCMPFUNC val) {
+		this->SetDirty(true);
 		m_AlphaFunc = val;
 	}
 	VxMath::VXCMPFUNC CKMaterial::GetZFunc() const {
 		return m_ZFunc;
 	}
 	void CKMaterial::SetZFunc(VxMath::VXCMPFUNC val) {
+		this->SetDirty(true);
 		m_ZFunc = val;
 	}
 	VxMath::VX_EFFECT CKMaterial::GetEffect() const {
 		return m_Effect;
 	}
 	void CKMaterial::SetEffect(VxMath::VX_EFFECT val) {
+		this->SetDirty(true);
 		m_Effect = val;
 	}
 
@@ -435,6 +435,7 @@ namespace LibCmo::CK2::ObjImpls {
 #pragma region Misc Section
 
 	void CKMesh::CleanMesh() {
+		this->SetDirty(true);
 		SetVertexCount(0);
 		SetMaterialSlotCount(0);
 		SetFaceCount(0);
@@ -446,6 +447,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetMeshFlags(VxMath::VXMESH_FLAGS flags) {
+		this->SetDirty(true);
 		// set value
 		m_Flags = flags;
 
@@ -466,6 +468,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetLitMode(VxMath::VXMESH_LITMODE mode) {
+		this->SetDirty(true);
 		switch (mode) {
 			case VxMath::VXMESH_LITMODE::VX_PRELITMESH:
 				yycc::cenum::add(m_Flags, VxMath::VXMESH_FLAGS::VXMESH_PRELITMODE);
@@ -490,6 +493,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetWrapMode(VxMath::VXTEXTURE_WRAPMODE mode) {
+		this->SetDirty(true);
 		if (yycc::cenum::has(mode, VxMath::VXTEXTURE_WRAPMODE::VXTEXTUREWRAP_U)) {
 			yycc::cenum::add(m_Flags, VxMath::VXMESH_FLAGS::VXMESH_WRAPU);
 		} else {
@@ -638,6 +642,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetVertexCount(CKDWORD count) {
+		this->SetDirty(true);
 		m_VertexCount = count;
 		m_VertexPosition.resize(count);
 		m_VertexNormal.resize(count);
@@ -647,26 +652,56 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	VxMath::VxVector3* CKMesh::GetVertexPositions() {
+		if (m_VertexCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_VertexPosition.data();
+	}
+
+	const VxMath::VxVector3* CKMesh::GetVertexPositions() const {
 		if (m_VertexCount == 0) return nullptr;
 		return m_VertexPosition.data();
 	}
 
 	VxMath::VxVector3* CKMesh::GetVertexNormals() {
+		if (m_VertexCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_VertexNormal.data();
+	}
+
+	const VxMath::VxVector3* CKMesh::GetVertexNormals() const {
 		if (m_VertexCount == 0) return nullptr;
 		return m_VertexNormal.data();
 	}
 
 	VxMath::VxVector2* CKMesh::GetVertexUVs() {
+		if (m_VertexCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_VertexUV.data();
+	}
+
+	const VxMath::VxVector2* CKMesh::GetVertexUVs() const {
 		if (m_VertexCount == 0) return nullptr;
 		return m_VertexUV.data();
 	}
 
 	CKDWORD* CKMesh::GetVertexColors() {
+		if (m_VertexCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_VertexColor.data();
+	}
+
+	const CKDWORD* CKMesh::GetVertexColors() const {
 		if (m_VertexCount == 0) return nullptr;
 		return m_VertexColor.data();
 	}
 
 	CKDWORD* CKMesh::GetVertexSpecularColors() {
+		if (m_VertexCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_VertexSpecularColor.data();
+	}
+
+	const CKDWORD* CKMesh::GetVertexSpecularColors() const {
 		if (m_VertexCount == 0) return nullptr;
 		return m_VertexSpecularColor.data();
 	}
@@ -680,11 +715,18 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetMaterialSlotCount(CKDWORD count) {
+		this->SetDirty(true);
 		m_MaterialSlotCount = count;
 		m_MaterialSlot.resize(count, nullptr);
 	}
 
 	CKMaterial** CKMesh::GetMaterialSlots() {
+		if (m_MaterialSlotCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_MaterialSlot.data();
+	}
+
+	CKMaterial* const* CKMesh::GetMaterialSlots() const {
 		if (m_MaterialSlotCount == 0) return nullptr;
 		return m_MaterialSlot.data();
 	}
@@ -698,6 +740,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetFaceCount(CKDWORD count) {
+		this->SetDirty(true);
 		m_FaceCount = count;
 		m_FaceIndices.resize(count * 3, 0);
 		m_FaceMtlIndex.resize(count, 0);
@@ -705,11 +748,23 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	CKWORD* CKMesh::GetFaceIndices() {
+		if (m_FaceCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_FaceIndices.data();
+	}
+
+	const CKWORD* CKMesh::GetFaceIndices() const {
 		if (m_FaceCount == 0) return nullptr;
 		return m_FaceIndices.data();
 	}
 
 	CKWORD* CKMesh::GetFaceMaterialSlotIndexs() {
+		if (m_FaceCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_FaceMtlIndex.data();
+	}
+
+	const CKWORD* CKMesh::GetFaceMaterialSlotIndexs() const {
 		if (m_FaceCount == 0) return nullptr;
 		return m_FaceMtlIndex.data();
 	}
@@ -717,6 +772,14 @@ namespace LibCmo::CK2::ObjImpls {
 	VxMath::VxVector3* CKMesh::GetFaceNormals(CKDWORD& stride) {
 		stride = CKSizeof(FaceData_t);
 
+		if (m_FaceCount == 0) return nullptr;
+		this->SetDirty(true);
+		return &m_FaceOthers.data()->m_Normal;
+	}
+
+	const VxMath::VxVector3* CKMesh::GetFaceNormals(CKDWORD& stride) const {
+		stride = CKSizeof(FaceData_t);
+
 		if (m_FaceCount == 0) return nullptr;
 		return &m_FaceOthers.data()->m_Normal;
 	}
@@ -730,11 +793,18 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKMesh::SetLineCount(CKDWORD count) {
+		this->SetDirty(true);
 		m_LineCount = count;
 		m_LineIndices.resize(count * 2, 0);
 	}
 
 	CKWORD* CKMesh::GetLineIndices() {
+		if (m_LineCount == 0) return nullptr;
+		this->SetDirty(true);
+		return m_LineIndices.data();
+	}
+
+	const CKWORD* CKMesh::GetLineIndices() const {
 		if (m_LineCount == 0) return nullptr;
 		return m_LineIndices.data();
 	}
@@ -53,30 +53,40 @@ namespace LibCmo::CK2::ObjImpls {
 		CKDWORD GetVertexCount() const;
 		void SetVertexCount(CKDWORD count);
 		VxMath::VxVector3* GetVertexPositions();
+		const VxMath::VxVector3* GetVertexPositions() const;
 		VxMath::VxVector3* GetVertexNormals();
+		const VxMath::VxVector3* GetVertexNormals() const;
 		VxMath::VxVector2* GetVertexUVs();
+		const VxMath::VxVector2* GetVertexUVs() const;
 		CKDWORD* GetVertexColors();
+		const CKDWORD* GetVertexColors() const;
 		CKDWORD* GetVertexSpecularColors();
+		const CKDWORD* GetVertexSpecularColors() const;
 	
 		// ===== Material Slot Section =====
 	public:
 		CKDWORD GetMaterialSlotCount() const;
 		void SetMaterialSlotCount(CKDWORD count);
 		CKMaterial** GetMaterialSlots();
+		CKMaterial* const* GetMaterialSlots() const;
 
 		// ===== Face Section =====
 	public:
 		CKDWORD GetFaceCount() const;
 		void SetFaceCount(CKDWORD count);
 		CKWORD* GetFaceIndices();
+		const CKWORD* GetFaceIndices() const;
 		CKWORD* GetFaceMaterialSlotIndexs();
+		const CKWORD* GetFaceMaterialSlotIndexs() const;
 		VxMath::VxVector3* GetFaceNormals(CKDWORD& stride);
+		const VxMath::VxVector3* GetFaceNormals(CKDWORD& stride) const;
 
 		// ===== Line Section =====
 	public:
 		CKDWORD GetLineCount() const;
 		void SetLineCount(CKDWORD count);
 		CKWORD* GetLineIndices();
+		const CKWORD* GetLineIndices() const;
 		
 	protected:
 		struct FaceData_t {
@@ -1,19 +1,21 @@
 #include "CKObject.hpp"
 #include "../CKStateChunk.hpp"
+#include "../CKContext.hpp"
+#include "../MgrImpls/CKObjectManager.hpp"
 #include <yycc/cenum.hpp>
 
 namespace LibCmo::CK2::ObjImpls {
 
 	CKObject::CKObject(CKContext* ctx, CK_ID ckid, CKSTRING name) :
 		m_ID(ckid),
-		m_Name(),
+		m_Name(ctx->InternName(name)),
 		m_Context(ctx),
-		m_ObjectFlags(CK_OBJECT_FLAGS::CK_OBJECT_VISIBLE) {
-		// set name with possible nullptr.
-		XContainer::NSXString::FromCKSTRING(m_Name, name);
-	}
+		m_ObjectFlags(CK_OBJECT_FLAGS::CK_OBJECT_VISIBLE),
+		m_IsDirty(true) {}
 
-	CKObject::~CKObject() {}
+	CKObject::~CKObject() {
+		m_Context->ReleaseName(m_Name);
+	}
 
 #pragma region Non-virtual Functions
 
@@ -21,15 +23,22 @@ namespace LibCmo::CK2::ObjImpls {
 		return m_ID;
 	}
 	CKSTRING CKObject::GetName() const {
-		return XContainer::NSXString::ToCKSTRING(m_Name);
+		return m_Name;
 	}
 	void CKObject::SetName(CKSTRING u8_name) {
-		XContainer::NSXString::FromCKSTRING(m_Name, u8_name);
+		this->SetDirty(true);
+		CKSTRING oldName = m_Name;
+		m_Name = m_Context->InternName(u8_name);
+		// update name index
+		m_Context->GetObjectManager()->NotifyObjectRenamed(this, oldName);
+		// old name is not used by this object anymore
+		m_Context->ReleaseName(oldName);
 	}
 	CK_OBJECT_FLAGS CKObject::GetObjectFlags() const {
 		return m_ObjectFlags;
 	}
 	void CKObject::SetObjectFlags(CK_OBJECT_FLAGS flags) {
+		this->SetDirty(true);
 		m_ObjectFlags = flags;
 	}
 	bool CKObject::IsToBeDeleted() const {
@@ -38,6 +47,12 @@ namespace LibCmo::CK2::ObjImpls {
 	CKContext* CKObject::GetCKContext() const {
 		return m_Context;
 	}
+	bool CKObject::IsDirty() const {
+		return m_IsDirty;
+	}
+	void CKObject::SetDirty(bool dirty) {
+		m_IsDirty = dirty;
+	}
 
 #pragma endregion
 
@@ -91,6 +106,7 @@ namespace LibCmo::CK2::ObjImpls {
 
 
 	void CKObject::Show(CK_OBJECT_SHOWOPTION show) {
+		this->SetDirty(true);
 		// clear all visible data of object flags
 		yycc::cenum::remove(m_ObjectFlags,
 			CK_OBJECT_FLAGS::CK_OBJECT_HIERACHICALHIDE,
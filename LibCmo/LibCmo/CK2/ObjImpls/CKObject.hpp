@@ -50,6 +50,23 @@ namespace LibCmo::CK2::ObjImpls {
 		void SetObjectFlags(CK_OBJECT_FLAGS flags);
 		bool IsToBeDeleted() const;
 		CKContext* GetCKContext() const;
+		/**
+		 * @brief Check whether this object is modified since it is loaded.
+		 * @return True if this object is modified or created by hand.
+		 * @remarks
+		 * \li The mutators of this object (including the functions returning mutable internal buffers) set this flag.
+		 * The rejected calls and const accessors do not set it.
+		 * \li CKFileReader clears this flag after the object is loaded from file.
+		 * CKFileWriter created from that reader reuses the loaded CKStateChunk of clean objects instead of saving them again.
+		 * \li If you modify this object in other ways, call SetDirty() manually.
+		*/
+		bool IsDirty() const;
+		/**
+		 * @brief Set the modification flag of this object.
+		 * @param[in] dirty True if this object is modified.
+		 * @see IsDirty()
+		*/
+		void SetDirty(bool dirty);
 
 		virtual CK_CLASSID GetClassID() { 
 			return CK_CLASSID::CKCID_OBJECT; 
@@ -86,9 +103,10 @@ namespace LibCmo::CK2::ObjImpls {
 
 	protected:
 		CK_ID m_ID;
-		XContainer::XString m_Name;
+		CKSTRING m_Name; /**< The name interned in CKContext. nullptr if this object has no name. */
 		CK_OBJECT_FLAGS m_ObjectFlags;
 		CKContext* m_Context;
+		bool m_IsDirty;
 	};
 
 }
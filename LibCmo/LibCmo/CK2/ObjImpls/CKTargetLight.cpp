@@ -66,6 +66,7 @@ namespace LibCmo::CK2::ObjImpls {
 	void CKTargetLight::SetTarget(CK3dEntity* target) {
 		// The target can not be self.
 		if (target == this) return;
+		this->SetDirty(true);
 
 		// First remove current target
 		CK3dEntity* old_target = static_cast<CK3dEntity*>(m_Context->GetObject(m_Target3dEntity));
@@ -340,6 +340,7 @@ namespace LibCmo::CK2::ObjImpls {
 #pragma region Visitor
 
 	CKBitmapData& CKTexture::GetUnderlyingData() {
+		this->SetDirty(true);
 		return m_ImageHost;
 	}
 
@@ -359,6 +360,7 @@ namespace LibCmo::CK2::ObjImpls {
 		if (!m_Context->GetPathManager()->ResolveFileName(filepath)) return false;
 
 		// try loading image
+		this->SetDirty(true);
 		if (!m_ImageHost.LoadImage(XContainer::NSXString::ToCKSTRING(filepath), slot)) return false;
 
 		// sync file name
@@ -370,6 +372,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKTexture::UseMipmap(bool isUse) {
+		this->SetDirty(true);
 		m_UseMipMap = isUse;
 
 		if (!m_UseMipMap) {
@@ -382,10 +385,17 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKTexture::SetMipmapLevel(CKDWORD level) {
+		this->SetDirty(true);
 		m_MipmapImages.resize(level);
 	}
 
 	VxMath::VxImageDescEx* CKTexture::GetMipmapLevelData(CKDWORD level) {
+		if (!m_UseMipMap || level >= m_MipmapImages.size()) return nullptr;
+		this->SetDirty(true);
+		return &m_MipmapImages[level];
+	}
+
+	const VxMath::VxImageDescEx* CKTexture::GetMipmapLevelData(CKDWORD level) const {
 		if (!m_UseMipMap || level >= m_MipmapImages.size()) return nullptr;
 		return &m_MipmapImages[level];
 	}
@@ -395,6 +405,7 @@ namespace LibCmo::CK2::ObjImpls {
 	}
 
 	void CKTexture::SetVideoFormat(VxMath::VX_PIXELFORMAT fmt) {
+		this->SetDirty(true);
 		m_VideoFormat = fmt;
 	}
 
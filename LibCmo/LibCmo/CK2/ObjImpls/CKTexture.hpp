@@ -19,6 +19,12 @@ namespace LibCmo::CK2::ObjImpls {
 		virtual bool Save(CKStateChunk* chunk, CKFileVisitor* file, CKDWORD flags) override;
 		virtual bool Load(CKStateChunk* chunk, CKFileVisitor* file) override;
 
+		/**
+		 * @brief Get the underlying bitmap data of this texture.
+		 * @return The mutable bitmap data.
+		 * @remarks This texture is marked as modified because the returned data may be changed.
+		 * Use the const version if you only read it.
+		*/
 		CKBitmapData& GetUnderlyingData();
 		const CKBitmapData& GetUnderlyingData() const;
 
@@ -35,6 +41,7 @@ namespace LibCmo::CK2::ObjImpls {
 		CKDWORD GetMipmapLevel() const;
 		void SetMipmapLevel(CKDWORD level);
 		VxMath::VxImageDescEx* GetMipmapLevelData(CKDWORD level);
+		const VxMath::VxImageDescEx* GetMipmapLevelData(CKDWORD level) const;
 
 		VxMath::VX_PIXELFORMAT GetVideoFormat() const;
 		void SetVideoFormat(VxMath::VX_PIXELFORMAT fmt);
@@ -43,7 +43,7 @@ namespace LibCmo {
 
 #pragma endregion
 
-	EncodingPair::EncodingPair(const std::u8string_view &enc_name) : inner(nullptr), is_valid(false), encoding_name(enc_name) {
+	EncodingPair::EncodingPair(const std::u8string_view &enc_name) : inner(nullptr), is_valid(false), is_ascii_compatible(false), encoding_name(enc_name) {
 		// Create private pair
 		this->inner = new PrivEncodingPair(this->encoding_name);
 		// Use empty string probe to check whether it works
@@ -54,15 +54,26 @@ namespace LibCmo {
 		if (!this->inner->ToUTF8("", utf8_cache)) return;
 		// Okey
 		this->is_valid = true;
+
+		// Use all ASCII characters to probe whether this encoding keep them unchanged.
+		// Some encodings like UTF-16 or Shift-JIS (backslash and tilde) do not.
+		std::string ascii_probe;
+		for (char c = 1; c < 0x7F; ++c) ascii_probe.push_back(c);
+		ascii_probe.push_back(static_cast<char>(0x7F));
+		std::u8string u8_ascii_probe(ascii_probe.begin(), ascii_probe.end());
+		if (!this->inner->ToUTF8(ascii_probe, utf8_cache) || utf8_cache != u8_ascii_probe) return;
+		if (!this->inner->ToOrdinary(u8_ascii_probe, ordinary_cache) || ordinary_cache != ascii_probe) return;
+		this->is_ascii_compatible = true;
 	}
 
 	EncodingPair::~EncodingPair() {
 		if (this->inner != nullptr) delete inner;
 	}
 
-	YYCC_IMPL_MOVE_CTOR(EncodingPair, rhs) : inner(rhs.inner), is_valid(rhs.is_valid), encoding_name(rhs.encoding_name) {
+	YYCC_IMPL_MOVE_CTOR(EncodingPair, rhs) : inner(rhs.inner), is_valid(rhs.is_valid), is_ascii_compatible(rhs.is_ascii_compatible), encoding_name(rhs.encoding_name) {
 		rhs.inner = nullptr;
 		rhs.is_valid = false;
+		rhs.is_ascii_compatible = false;
 	}
 
 	YYCC_IMPL_MOVE_OPER(EncodingPair, rhs) {
@@ -70,10 +81,12 @@ namespace LibCmo {
 
 		this->inner = rhs.inner;
 		this->is_valid = rhs.is_valid;
+		this->is_ascii_compatible = rhs.is_ascii_compatible;
 		this->encoding_name = rhs.encoding_name;
 
 		rhs.inner = nullptr;
 		rhs.is_valid = false;
+		rhs.is_ascii_compatible = false;
 
 		return *this;
 	}
@@ -90,6 +103,10 @@ namespace LibCmo {
 		return this->is_valid;
 	}
 
+	bool EncodingPair::IsAsciiCompatible() const {
+		return this->is_ascii_compatible;
+	}
+
 	std::u8string_view EncodingPair::GetEncodingName() const {
 		return this->encoding_name;
 	}
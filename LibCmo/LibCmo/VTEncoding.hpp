@@ -18,11 +18,18 @@ namespace LibCmo {
 		bool ToUTF8(const std::string_view& src, std::u8string& dst);
 		bool ToOrdinary(const std::u8string_view& src, std::string& dst);
 		bool IsValid() const;
+		/**
+		 * @brief Check whether this encoding keeps ASCII characters unchanged in both directions.
+		 * @details If it is, pure ASCII strings can be copied directly without calling converter.
+		 * @return True if it is. Always false for invalid encoding.
+		*/
+		bool IsAsciiCompatible() const;
 		std::u8string_view GetEncodingName() const;
 
 	private:
 		PrivEncodingPair* inner;
 		bool is_valid;
+		bool is_ascii_compatible;
 		std::u8string encoding_name;
 	};
 
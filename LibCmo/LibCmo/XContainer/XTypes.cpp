@@ -4,9 +4,43 @@
 #include "../CK2/ObjImpls/CKObject.hpp"
 #include <type_traits>
 #include <algorithm>
+#include <bit>
 
 namespace LibCmo::XContainer {
 
+#pragma region XBitArray
+
+	/**
+	 * @brief Get the mask of valid bits in the last word of XBitArray with given size.
+	 * @param[in] size The count of bit flags.
+	 * @return The mask. All bits are set if the last word is full.
+	*/
+	static XBitArray::WordType GetLastWordMask(size_t size) {
+		size_t remain = size % XBitArray::c_WordBits;
+		if (remain == 0u) return ~static_cast<XBitArray::WordType>(0u);
+		return (static_cast<XBitArray::WordType>(1u) << remain) - 1u;
+	}
+
+	void XBitArray::resize(size_t newsize, bool value) {
+		size_t oldsize = m_Size;
+		m_Words.resize((newsize + c_WordBits - 1u) / c_WordBits, 0u);
+		m_Size = newsize;
+
+		if (newsize > oldsize) {
+			// fill new added bits if needed
+			if (value) {
+				for (size_t i = oldsize; i < newsize; ++i) {
+					m_Words[i / c_WordBits] |= static_cast<WordType>(1u) << (i % c_WordBits);
+				}
+			}
+		} else {
+			// clear the bits exceeding new size in the last word
+			if (!m_Words.empty()) m_Words.back() &= GetLastWordMask(m_Size);
+		}
+	}
+
+#pragma endregion
+
 	namespace NSXBitArray {
 
 		void Resize(XBitArray& ba, CKDWORD newsize) {
@@ -18,9 +52,23 @@ namespace LibCmo::XContainer {
 				Resize(thisba, static_cast<CKDWORD>(thatba.size()));
 			}
 
-			for (size_t i = 0; i < thisba.size(); ++i) {
-				thisba[i] = thisba[i] || thatba[i];
+			// thisba has at least the same words with thatba now.
+			auto& thiswords = thisba.GetWords();
+			const auto& thatwords = thatba.GetWords();
+			for (size_t i = 0; i < thatwords.size(); ++i) {
+				thiswords[i] |= thatwords[i];
+			}
+		}
+
+		void And(XBitArray& thisba, const XBitArray& thatba) {
+			auto& thiswords = thisba.GetWords();
+			const auto& thatwords = thatba.GetWords();
+			size_t common = std::min(thiswords.size(), thatwords.size());
+			for (size_t i = 0; i < common; ++i) {
+				thiswords[i] &= thatwords[i];
 			}
+			// the words exceeding thatba are treated as zero
+			std::fill(thiswords.begin() + common, thiswords.end(), static_cast<XBitArray::WordType>(0u));
 		}
 
 		bool IsSet(const XBitArray& ba, CKDWORD n) {
@@ -32,26 +80,40 @@ namespace LibCmo::XContainer {
 			if (n >= ba.size()) {
 				ba.resize(n + 1);
 			}
-			ba[n] = true;
+			ba.GetWords()[n / XBitArray::c_WordBits] |= static_cast<XBitArray::WordType>(1u) << (n % XBitArray::c_WordBits);
 		}
 
 		void Unset(XBitArray& ba, CKDWORD n)  {
 			if (n >= ba.size()) return;
-			ba[n] = false;
+			ba.GetWords()[n / XBitArray::c_WordBits] &= ~(static_cast<XBitArray::WordType>(1u) << (n % XBitArray::c_WordBits));
 		}
 
 		template<bool BCondition>
 		static bool GenericGetBitPosition(const XBitArray& ba, CKDWORD n, CKDWORD& got) {
+			const auto& words = ba.GetWords();
 			CKDWORD counter = 0;
-			for (size_t i = 0; i < ba.size(); ++i) {
-				if (ba[i] == BCondition) {
-					if (counter == n) {
-						got = static_cast<CKDWORD>(i);
-						return true;
-					} else {
-						++counter;
-					}
+			for (size_t i = 0; i < words.size(); ++i) {
+				// get the word in which the bits we want are set. 
+				// for unset bit finding, the bits exceeding size should not be counted.
+				XBitArray::WordType word = words[i];
+				if constexpr (!BCondition) {
+					word = ~word;
+					if (i + 1u == words.size()) word &= GetLastWordMask(ba.size());
+				}
+
+				// skip whole word if n-th bit is not in it
+				CKDWORD bits = static_cast<CKDWORD>(std::popcount(word));
+				if (counter + bits <= n) {
+					counter += bits;
+					continue;
+				}
+
+				// remove lower bits until we reach n-th bit
+				for (; counter < n; ++counter) {
+					word &= word - 1u;
 				}
+				got = static_cast<CKDWORD>(i * XBitArray::c_WordBits + std::countr_zero(word));
+				return true;
 			}
 
 			return false;
@@ -65,6 +127,14 @@ namespace LibCmo::XContainer {
 			return GenericGetBitPosition<false>(ba, n, got);
 		}
 
+		CKDWORD BitSet(const XBitArray& ba) {
+			CKDWORD counter = 0;
+			for (const auto& word : ba.GetWords()) {
+				counter += static_cast<CKDWORD>(std::popcount(word));
+			}
+			return counter;
+		}
+
 	}
 
 	namespace NSXString {
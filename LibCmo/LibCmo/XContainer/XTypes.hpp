@@ -23,11 +23,56 @@ namespace LibCmo::XContainer {
 	/**
 	 * @brief The representation of a set of bit flags (memory optimized to reduce occupied size).
 	 * @remarks 
-	 * \li This class is implemented by specialized \c std::vector<bool>.
+	 * \li This class is implemented by an array of 64-bit words,
+	 * so that searching and merging can be done word by word instead of bit by bit.
 	 * \li This class define a set of bit flags that may be treated as a virtual array but are stored in an efficient manner.
-	 * \li The class has methods to set, clear and return the i-th bit, resize the array, etc.
+	 * \li This class only provides a minimal \c std::vector<bool> like interface.
+	 * The functions presented in original Virtools SDK are located in NSXBitArray.
 	*/
-	using XBitArray = std::vector<bool>;
+	class XBitArray {
+	public:
+		using WordType = CKQWORD;
+		static constexpr CKDWORD c_WordBits = 64u;
+
+		XBitArray() : m_Words(), m_Size(0) {}
+		/**
+		 * @brief Get the count of bit flags.
+		*/
+		size_t size() const { return m_Size; }
+		/**
+		 * @brief Check whether there is no bit flags.
+		*/
+		bool empty() const { return m_Size == 0u; }
+		/**
+		 * @brief Resize this array.
+		 * @param[in] newsize New size (the count of bit flags).
+		 * @param[in] value The value of new added bit flags.
+		*/
+		void resize(size_t newsize, bool value = false);
+		/**
+		 * @brief Remove all bit flags.
+		*/
+		void clear() { m_Words.clear(); m_Size = 0u; }
+		/**
+		 * @brief Get the value of specified bit flag without range check.
+		*/
+		bool operator[](size_t n) const { return (m_Words[n / c_WordBits] >> (n % c_WordBits)) & 1u; }
+
+		/**
+		 * @brief Get the underlying words.
+		 * @details The bits exceeding size() in the last word are always zero.
+		*/
+		const std::vector<WordType>& GetWords() const { return m_Words; }
+		/**
+		 * @brief Get the mutable underlying words.
+		 * @remarks Caller must keep the bits exceeding size() in the last word zero.
+		*/
+		std::vector<WordType>& GetWords() { return m_Words; }
+
+	private:
+		std::vector<WordType> m_Words;
+		size_t m_Size;
+	};
 
 	/**
 	 * @brief The representation of an array.
@@ -114,6 +159,15 @@ namespace LibCmo::XContainer {
 		 * @param[in] thatba Other XBitArray will be merged.
 		*/
 		void Or(XBitArray& thisba, const XBitArray& thatba);
+		/**
+		 * @brief Intersect 2 XBitArray like performing <TT>thisba & thatba</TT> for each flags.
+		 * @details
+		 * The size of this XBitArray is not changed.
+		 * The flags exceeding the size of other XBitArray are treated as unset.
+		 * @param[in] thisba The intersecting XBitArray.
+		 * @param[in] thatba Other XBitArray will be intersected.
+		*/
+		void And(XBitArray& thisba, const XBitArray& thatba);
 
 		/**
 		 * @brief Check whether bit flag is set.
@@ -151,6 +205,12 @@ namespace LibCmo::XContainer {
 		 * @return True if we found, otherwise false.
 		*/
 		bool GetUnsetBitPosition(const XBitArray& ba, CKDWORD n, CKDWORD& got);
+		/**
+		 * @brief Count the set(1) bits.
+		 * @param[in] ba The XBitArray for counting.
+		 * @return The count of set bits.
+		*/
+		CKDWORD BitSet(const XBitArray& ba);
 
 	}
 	
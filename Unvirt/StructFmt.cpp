@@ -313,7 +313,7 @@ namespace Unvirt::StructFmt {
 		    u8"File Name",
 		});
 		for (LibCmo::CKDWORD i = 0; i < slot_count; ++i) {
-			auto desc = bd.GetImageDesc(i);
+			auto desc = bd.GetReadOnlyImageDesc(i);
 
 			image_table.add_row({
 			    strop::printf(u8"#%" PRIuCKDWORD, i),
@@ -575,7 +575,7 @@ namespace Unvirt::StructFmt {
 		auto col_type = Docstring::GetClassIdName(obj.ObjectCid);
 		auto col_object = PrintColorfulBool(obj.ObjPtr != nullptr);
 		auto col_chunk = PrintColorfulBool(obj.Data != nullptr);
-		auto col_name = PrintCKSTRING(LibCmo::XContainer::NSXString::ToCKSTRING(obj.Name));
+		auto col_name = PrintCKSTRING(obj.Name);
 
 		// Return first if we are simple layout
 		if (!full_detail) {
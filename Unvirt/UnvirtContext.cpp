@@ -450,8 +450,10 @@ namespace Unvirt::Context {
 				m_SearchIdxResult.clear();
 
 				size_t counter = 0;
+				LibCmo::XContainer::XString name;
 				for (const auto& obj : m_FileReader->GetFileObjects()) {
-					if (search_fct(obj.Name)) {
+					LibCmo::XContainer::NSXString::FromCKSTRING(name, obj.Name);
+					if (search_fct(name)) {
 						m_SearchIdxResult.emplace_back(counter);
 					}
 					++counter;